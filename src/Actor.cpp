@@ -13,6 +13,9 @@
  */
 
 #include "Actor.hpp"
+#include "Assets.hpp"
+#include "Trace.hpp"
+#include "Counters.hpp"
 
 #define window_width 1024
 #define window_height 768
@@ -20,8 +23,133 @@
 #define left_border 95
 #define right_border 890
 
+#define free_list_sizes 8
+
 using namespace std;
 
+/*
+ * The files of the textures and sounds used while playing, made once
+ * so that using them does not allocate.
+ */
+static string const enemy_files[]{"sprites/enemy1.png", "sprites/enemy2.png",
+				  "sprites/enemy3.png", "sprites/enemy4.png"};
+static string const boss_file{"sprites/boss_enemy.png"};
+static string const crate_broken_file{"sprites/crate_broken.png"};
+static string const crate_broken2_file{"sprites/crate_broken2.png"};
+static string const player_projectile_file{"sprites/player_projectile.gif"};
+static string const enemy_projectile_file{"sprites/enemy_projectile.gif"};
+static string const player_shot_sound{"sounds/no.wav"};
+static string const enemy_shot_sound{"sounds/paper_toss.wav"};
+static string const player_hit_sound{"sounds/wilhelm.wav"};
+
+/*
+ * The memory of deleted actors, a free list for each size of actor,
+ * freed when the thread ends.
+ */
+struct Free_Block
+{
+    Free_Block * next;
+};
+
+struct Free_List
+{
+    size_t size;
+    Free_Block * first;
+};
+
+struct Actor_Memory
+{
+    Free_List lists[free_list_sizes];
+
+    ~Actor_Memory()
+    {
+	for (Free_List & list : lists)
+	    while (list.first != nullptr)
+	    {
+		Free_Block * block{list.first};
+		list.first = block -> next;
+		::operator delete(block);
+	    }
+    }
+};
+
+static thread_local Actor_Memory actor_memory{};
+
+/*
+ * FUNCTION free_list(size_t)
+ *
+ * Returns the free list of a size, or none when there are already
+ * free lists for free_list_sizes other sizes.
+ */
+
+static Free_List * free_list(size_t size)
+{
+    for (Free_List & list : actor_memory.lists)
+    {
+	if (list.size == 0)
+	    list.size = size;
+	if (list.size == size)
+	    return &list;
+    }
+
+    return nullptr;
+}
+
+/*
+ * --------------------------------------------------
+ * ----------------- RANDOM_ENGINE ------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Random_Engine(unsigned)
+ *
+ * Constructor for Random_Engine, takes the seed.
+ */
+
+Random_Engine::Random_Engine(unsigned seed) :
+    engine{seed}
+{
+}
+
+/*
+ * FUNCTION operator()()
+ *
+ * Returns the next random number.
+ */
+
+Random_Engine::result_type Random_Engine::operator()()
+{
+    ++draws;
+    return engine();
+}
+
+/*
+ * FUNCTION restore(unsigned, uint64_t)
+ *
+ * Puts the engine in the state it had after draws numbers
+ * from the seed. A game only draws a few numbers per second
+ * so this is fast.
+ */
+
+void Random_Engine::restore(unsigned seed, uint64_t new_draws)
+{
+    engine.seed(seed);
+    engine.discard(new_draws);
+    draws = new_draws;
+}
+
+/*
+ * FUNCTION get_draws()
+ *
+ * Returns how many numbers have been drawn since the seed.
+ */
+
+uint64_t Random_Engine::get_draws() const
+{
+    return draws;
+}
+
 /*
  * --------------------------------------------------
  * --------------------- ACTOR ----------------------
@@ -39,6 +167,75 @@ void Actor::draw(sf::RenderWindow & window)
     window.draw(sprite);
 }
 
+/*
+ * FUNCTION operator new(size_t)
+ *
+ * Returns the memory of a deleted actor of the same size, or new
+ * memory if there is none.
+ */
+
+void * Actor::operator new(size_t size)
+{
+    Free_List * list{free_list(size)};
+
+    if (list == nullptr || list -> first == nullptr)
+	return ::operator new(size);
+
+    Free_Block * block{list -> first};
+    list -> first = block -> next;
+    return block;
+}
+
+/*
+ * FUNCTION operator delete(void *, size_t)
+ *
+ * Keeps the memory of an actor for the next of the same size.
+ */
+
+void Actor::operator delete(void * pointer, size_t size)
+{
+    if (pointer == nullptr)
+	return;
+
+    Free_List * list{free_list(size)};
+
+    if (list == nullptr)
+    {
+	::operator delete(pointer);
+	return;
+    }
+
+    Free_Block * block{static_cast<Free_Block *>(pointer)};
+    block -> next = list -> first;
+    list -> first = block;
+}
+
+/*
+ * FUNCTION reserve(size_t, size_t)
+ *
+ * Makes sure that this thread keeps memory for at least count
+ * actors of a size, so that making them does not allocate.
+ */
+
+void Actor::reserve(size_t size, size_t count)
+{
+    Free_List * list{free_list(size)};
+
+    if (list == nullptr)
+	return;
+
+    size_t kept{};
+    for (Free_Block * block{list -> first}; block != nullptr; block = block -> next)
+	++kept;
+
+    for (; kept < count; ++kept)
+    {
+	Free_Block * block{static_cast<Free_Block *>(::operator new(size))};
+	block -> next = list -> first;
+	list -> first = block;
+    }
+}
+
 /*
  * FUNCTION get_position() 
  *
@@ -61,6 +258,42 @@ sf::FloatRect Actor::get_size()
     return sprite.getGlobalBounds(); 
 }
 
+/*
+ * FUNCTION save_state(State_Writer &)
+ *
+ * Writes the position and the booleans of an actor.
+ */
+
+void Actor::save_state(State_Writer & writer) const
+{
+    writer.write_float(position.x);
+    writer.write_float(position.y);
+    writer.write(shoot | hit_border << 1 | hit_bottom << 2 |
+		 make_new_boss << 3 | alive << 4 | removed << 5);
+}
+
+/*
+ * FUNCTION load_state(State_Reader &)
+ *
+ * Reads what save_state wrote and moves the sprite.
+ */
+
+void Actor::load_state(State_Reader & reader)
+{
+    position.x = reader.read_float();
+    position.y = reader.read_float();
+
+    uint64_t flags = reader.read();
+    shoot = flags & 1;
+    hit_border = flags & 2;
+    hit_bottom = flags & 4;
+    make_new_boss = flags & 8;
+    alive = flags & 16;
+    removed = flags & 32;
+
+    sprite.setPosition(position);
+}
+
 /*
  * --------------------------------------------------
  * --------------------- PLAYER ---------------------
@@ -75,11 +308,10 @@ sf::FloatRect Actor::get_size()
 
 Player::Player()
 {
-    if(!texture.loadFromFile("sprites/player.png"))
-	throw invalid_argument("Player not found!");
-    sprite.setTexture(texture);
-    position = sf::Vector2f((window_width/2 - texture.getSize().x / 2),
-			    (window_height - texture.getSize().y * 2));
+    Assets::apply_texture(sprite, "sprites/player.png", Assets::PLAYER);
+    sf::FloatRect size{sprite.getLocalBounds()};
+    position = sf::Vector2f((window_width/2 - size.width / 2),
+			    (window_height - size.height * 2));
 
     energy_bar.setFillColor(sf::Color::Yellow);
     energy_bar.setPosition(window_width/2 - energy, 30);
@@ -94,12 +326,14 @@ void Player::draw(sf::RenderWindow & window)
 /*
  * FUNCTION update(sf::Time &)
  *
- * Updates the position of the user and adds time to the
- * projectile delay.
+ * Reads the held keys from the input source, updates the position
+ * of the user and adds time to the projectile delay.
  */
 
 void Player::update(sf::Time & delta)
 {
+    controllers.set_keys(input -> next_keys(delta));
+
     projectile_delay += delta.asSeconds();
     energy_delay += delta.asSeconds();
     
@@ -134,36 +368,51 @@ void Player::update(sf::Time & delta)
 /*
  * FUNCTION handle_input(sf::Event & event)
  *
- * Handles user inputs for player (shooting and moving)
+ * Passes user inputs for player (shooting and moving) on to
+ * the input source.
  */
 
 void Player::handle_input(sf::Event & event)
 {
-    switch (event.type)
-    {
-        case sf::Event::KeyPressed:
-            controllers.handle_input(true, event.key.code);
-            break;
-        case sf::Event::KeyReleased:
-            controllers.handle_input(false, event.key.code);
-            break;
-        default:
-            break;
-    }
+    input -> handle_input(event);
 }
 
 /*
- * FUNCTION create_projectile(std::vector<std::unique_ptr<Projectile>> &)
+ * FUNCTION set_input(unique_ptr<Input_Source>)
+ *
+ * Replaces the input source, for example with a bot.
+ */
+
+void Player::set_input(unique_ptr<Input_Source> new_input)
+{
+    input = move(new_input);
+}
+
+/*
+ * FUNCTION get_keys()
+ *
+ * Returns the keys held in the last update.
+ */
+
+unsigned Player::get_keys() const
+{
+    return controllers.get_keys();
+}
+
+/*
+ * FUNCTION create_projectile(std::vector<std::unique_ptr<Projectile>> &, Random_Engine &)
  *
  * Creates a user projectile if controllers.shoot() = true, with
  * a delay of 1 second in case the shooting key is held.
  */
 
-void Player::create_projectile(std::vector<std::unique_ptr<Projectile>> & projectiles)
+void Player::create_projectile(std::vector<std::unique_ptr<Projectile>> & projectiles,
+			       Random_Engine &)
 {   
     if(controllers.shoot() && round(projectile_delay) >= 1.0)
     {
 	projectiles.push_back(make_unique<Projectile>(position, true));
+	Counters::add(Counters::PROJECTILES_SPAWNED);
 	projectile_delay = 0.0;
     }
 }
@@ -172,26 +421,53 @@ void Player::create_projectile(std::vector<std::unique_ptr<Projectile>> & projec
  * FUNCTION handle_collision(bool, Info_Strip &)
  *
  * Handles collision for the user, plays a sound, sleeps for
- * 2 seconds and then remove a life. If there only is one life
- * left, the user loses the game.
+ * 2 seconds (not in headless mode) and then remove a life. If there
+ * only is one life left, the user loses the game.
  */
 
 void Player::handle_collision(bool enemy_collide, Info_Strip & strip)
 {
-    if (!hit_buffer.loadFromFile("sounds/wilhelm.wav"))
-	throw invalid_argument("Wilhelm sound not found!");
+    Assets::play_sound(player_hit_sound, Assets::PLAYER);
 
-    hit_sound.setBuffer(hit_buffer);
-    hit_sound.play();
-    
-    sf::sleep(sf::seconds(2.0));
+    if (!Assets::headless())
+	sf::sleep(sf::seconds(2.0));
     
     if(strip.update_lives(-1) >= 1 && !enemy_collide)
-	position.x = window_width/2 - texture.getSize().x / 2;
+	position.x = window_width/2 - sprite.getLocalBounds().width / 2;
     else
 	alive = false;
 }
 
+/*
+ * FUNCTION save_state(State_Writer &)
+ *
+ * Writes the state of the player, but not the input source.
+ */
+
+void Player::save_state(State_Writer & writer) const
+{
+    Actor::save_state(writer);
+    writer.write_float(projectile_delay);
+    writer.write_float(energy_delay);
+    writer.write_int(energy);
+}
+
+/*
+ * FUNCTION load_state(State_Reader &)
+ *
+ * Reads what save_state wrote.
+ */
+
+void Player::load_state(State_Reader & reader)
+{
+    Actor::load_state(reader);
+    projectile_delay = reader.read_float();
+    energy_delay = reader.read_float();
+    energy = reader.read_int();
+
+    energy_bar.setSize(sf::Vector2f(energy * 2, 10));
+}
+
 /*
  * --------------------------------------------------
  * --------------------- ENEMY ----------------------
@@ -199,24 +475,21 @@ void Player::handle_collision(bool enemy_collide, Info_Strip & strip)
  */
 
 /*
- * FUNCTION Enemy(float, float, int)
+ * FUNCTION Enemy(float, float, int, Difficulty const &)
  *
- * Constructor for an enemy. Takes in coordinates as floats
- * and enemy type (different texture for each enemy row in the swarm).
+ * Constructor for an enemy. Takes in coordinates as floats,
+ * enemy type (different texture for each enemy row in the swarm)
+ * and the difficulty that decides how often it shoots.
  */
 
-Enemy::Enemy(float x, float y, int type)
+Enemy::Enemy(float x, float y, int type_init, Difficulty const & difficulty_init) :
+    type{type_init}, difficulty{difficulty_init}
 {
-    stringstream sprite_type;
     initialized_y = y; 
     position = sf::Vector2f(x, y - 200); //-100
 
-    // Load different sprites for different enemy rows
-    sprite_type << "sprites/enemy" << type << ".png";
-	
-    if(!texture.loadFromFile(sprite_type.str()))
-	throw invalid_argument("Enemy not found!");
-    sprite.setTexture(texture);
+    // Load different sprites for different enemy rows, there are four
+    Assets::apply_texture(sprite, enemy_files[(type + 3) % 4], Assets::ENEMY);
     sprite.setPosition(position);
 }
 
@@ -275,22 +548,28 @@ void Enemy::change_direction()
 }
 
 /*
- * FUNCTION create_projectile(std::vector<std::unique_ptr<Projectile>> &)
+ * FUNCTION create_projectile(std::vector<std::unique_ptr<Projectile>> &, Random_Engine &)
  *
- * Creates an enemy projectile, with a 10% chance of shooting each second.
+ * Creates an enemy projectile, with a 10% chance of shooting each second
+ * by default. The chance and delay are set by the difficulty and the
+ * random numbers come from the Field so that a game can be repeated.
  */
 
-void Enemy::create_projectile(std::vector<std::unique_ptr<Projectile>> & projectiles)
+void Enemy::create_projectile(std::vector<std::unique_ptr<Projectile>> & projectiles,
+			      Random_Engine & random_engine)
 {
     if (shoot)
     {
-	if (projectile_delay > 1.0)
+	if (projectile_delay > difficulty.enemy_shot_delay)
 	{
-	    // Enemies has a 10% chance of shooting a projectile
-	    int random = rand() % 10 + 0;
+	    // Enemies has a 1 in enemy_shot_chance chance of shooting a projectile
+	    int random = random_engine() % difficulty.enemy_shot_chance;
 	
-	    if (random == 1)
+	    if (random == 0)
+	    {
 		projectiles.push_back(make_unique<Projectile>(position, false));
+		Counters::add(Counters::PROJECTILES_SPAWNED);
+	    }
 	    
 	    projectile_delay = 0.0;
 	}
@@ -315,6 +594,49 @@ void Enemy::handle_collision(bool enemy_collide, Info_Strip & strip)
     }
 }
 
+/*
+ * FUNCTION save_state(State_Writer &)
+ *
+ * Writes the state of the enemy, the type is written by the Field.
+ */
+
+void Enemy::save_state(State_Writer & writer) const
+{
+    Actor::save_state(writer);
+    writer.write_float(moving_delay);
+    writer.write_float(projectile_delay);
+    writer.write_float(change_direction_delay);
+    writer.write_int(direction);
+    writer.write_float(initialized_y);
+}
+
+/*
+ * FUNCTION load_state(State_Reader &)
+ *
+ * Reads what save_state wrote.
+ */
+
+void Enemy::load_state(State_Reader & reader)
+{
+    Actor::load_state(reader);
+    moving_delay = reader.read_float();
+    projectile_delay = reader.read_float();
+    change_direction_delay = reader.read_float();
+    direction = reader.read_int();
+    initialized_y = reader.read_float();
+}
+
+/*
+ * FUNCTION get_type()
+ *
+ * Returns which row type the enemy was created as.
+ */
+
+int Enemy::get_type() const
+{
+    return type;
+}
+
 /*
  * --------------------------------------------------
  * ------------------- BOSS ENEMY -------------------
@@ -322,17 +644,17 @@ void Enemy::handle_collision(bool enemy_collide, Info_Strip & strip)
  */
 
 /*
- * FUNCTION Boss_Enemy()
+ * FUNCTION Boss_Enemy(float)
  *
  * Constructor for a boss enemy, loads the texture and sets
- * starting position.
+ * starting position. Takes the number of seconds between
+ * the appearances.
  */
 
-Boss_Enemy::Boss_Enemy()
+Boss_Enemy::Boss_Enemy(float interval_init) :
+    interval{interval_init}
 {
-    if(!texture.loadFromFile("sprites/boss_enemy.png"))
-       throw invalid_argument("Boss sprite not found!");
-    sprite.setTexture(texture);
+    Assets::apply_texture(sprite, boss_file, Assets::BOSS);
     sprite.setScale(0.7, 0.7);
 
     position = sf::Vector2f(-105.0, 50.0);
@@ -343,15 +665,18 @@ Boss_Enemy::Boss_Enemy()
 /* 
  * FUNCTION update(sf::Time &)
  * 
- * Spawns a boss each 30 seconds of the game play.
+ * Spawns a boss each interval seconds (30 by default) of the game play.
  */
 
 void Boss_Enemy::update(sf::Time & delta)
 {
     boss_delay += delta.asSeconds();
 
-    if (round(boss_delay) >= 30.0)
+    if (round(boss_delay) >= interval)
     {
+	if (position.x == -105.0f)
+	    TRACE_INSTANT("boss arrives");
+
 	float distance = 250.0f * (delta.asMicroseconds() / 1500000.0f);
 	position.x += distance;
 	sprite.setPosition(position);
@@ -389,6 +714,35 @@ void Boss_Enemy::handle_collision(bool enemy_collide, Info_Strip & strip)
     }
 }
 
+/* 
+ * FUNCTION save_state(State_Writer &)
+ * 
+ * Writes the state of the boss enemy.
+ */
+
+void Boss_Enemy::save_state(State_Writer & writer) const
+{
+    Actor::save_state(writer);
+    writer.write_float(boss_delay);
+    writer.write_int(health);
+}
+
+/* 
+ * FUNCTION load_state(State_Reader &)
+ * 
+ * Reads what save_state wrote, a hit boss is smaller.
+ */
+
+void Boss_Enemy::load_state(State_Reader & reader)
+{
+    Actor::load_state(reader);
+    boss_delay = reader.read_float();
+    health = reader.read_int();
+
+    if (health == 1)
+	sprite.setScale(0.5, 0.5);
+}
+
 /*
  * --------------------------------------------------
  * --------------------- BLOCK ----------------------
@@ -398,45 +752,35 @@ void Boss_Enemy::handle_collision(bool enemy_collide, Info_Strip & strip)
 /* 
  * FUNCTION Block(float, float)
  * 
- * Constructor for block, takes in coordinates as floats and loads three
- * textures for degrading.
+ * Constructor for block, takes in coordinates as floats and loads
+ * the texture of a whole crate. The broken crates are loaded too,
+ * so that the first hit does not load them in the game loop.
  */
 
 Block::Block(float x, float y)
 {
     position = sf::Vector2f(x, y);
 
-    if(!texture.loadFromFile("sprites/crate.png"))
-	throw invalid_argument("Broken crate sprite not found!");
-	
-    if(!broken.loadFromFile("sprites/crate_broken.png"))
-	throw invalid_argument("Broken crate sprite not found!");
-    	
-    if(!more_broken.loadFromFile("sprites/crate_broken2.png"))
-	throw invalid_argument("Broken crate sprite not found!");
-    
-    sprite.setTexture(texture);
+    Assets::apply_texture(sprite, crate_broken_file, Assets::BLOCK);
+    Assets::apply_texture(sprite, crate_broken2_file, Assets::BLOCK);
+    Assets::apply_texture(sprite, "sprites/crate.png", Assets::BLOCK);
     sprite.setPosition(position); 
 }
 
 /* 
  * FUNCTION update(sf::Time &)
  * 
- * Degrades the block depending on health.
+ * Nothing to update, the block is degraded when it is hit.
  */
 
 void Block::update(sf::Time &)
 {
-    if (health == 1)
-	sprite.setTexture(more_broken);
-    else if (health == 2)
-	sprite.setTexture(broken);
 }
 
 /* 
  * FUNCTION handle_collision(bool, Info_Strip &)
  * 
- * Degrades the block or removes it if health = 1.
+ * Degrades the block depending on health or removes it if health = 1.
  */
 
 void Block::handle_collision(bool, Info_Strip &)
@@ -445,6 +789,40 @@ void Block::handle_collision(bool, Info_Strip &)
 	removed = true;
     else
 	--health;
+
+    if (health == 1)
+	Assets::apply_texture(sprite, crate_broken2_file, Assets::BLOCK);
+    else if (health == 2)
+	Assets::apply_texture(sprite, crate_broken_file, Assets::BLOCK);
+}
+
+/* 
+ * FUNCTION save_state(State_Writer &)
+ * 
+ * Writes the state of the block.
+ */
+
+void Block::save_state(State_Writer & writer) const
+{
+    Actor::save_state(writer);
+    writer.write_int(health);
+}
+
+/* 
+ * FUNCTION load_state(State_Reader &)
+ * 
+ * Reads what save_state wrote and shows how broken the block is.
+ */
+
+void Block::load_state(State_Reader & reader)
+{
+    Actor::load_state(reader);
+    health = reader.read_int();
+
+    if (health == 1)
+	Assets::apply_texture(sprite, crate_broken2_file, Assets::BLOCK);
+    else if (health == 2)
+	Assets::apply_texture(sprite, crate_broken_file, Assets::BLOCK);
 }
 
 /*
@@ -466,36 +844,37 @@ Projectile::Projectile(sf::Vector2f shooter_position, bool direction) :
     
     if (from_player)
     {	
-	if(!texture.loadFromFile("sprites/player_projectile.gif"))
-	    throw invalid_argument("Player projectile sprite not found!");
-
-	if (!player_buffer.loadFromFile("sounds/no.wav"))
-	    throw invalid_argument("Projectile sound not found!");
+	Assets::apply_texture(sprite, player_projectile_file, Assets::PROJECTILE);
+	Assets::play_sound(player_shot_sound, Assets::PROJECTILE);
 
 	position.y -= 40;
-    
-	player_sound.setBuffer(player_buffer);
-	player_sound.play();
     }
     else
     {	
-	if(!texture.loadFromFile("sprites/enemy_projectile.gif"))
-	    throw invalid_argument("Enemy projectile sprite not found!");
-
-	if (!enemy_buffer.loadFromFile("sounds/paper_toss.wav"))
-	    throw invalid_argument("Projectile sound not found!");
-
-        enemy_sound.setBuffer(enemy_buffer);
-        enemy_sound.play();
+	Assets::apply_texture(sprite, enemy_projectile_file, Assets::PROJECTILE);
+	Assets::play_sound(enemy_shot_sound, Assets::PROJECTILE);
 
 	position.y += 40;
     }
 
-    sprite.setTexture(texture);
     sprite.setPosition(position);
 
 }
 
+/* 
+ * FUNCTION Projectile(bool)
+ * 
+ * Constructor for a projectile that gets its state from load_state.
+ * Only the texture is applied, so restoring a state plays no sound.
+ */
+
+Projectile::Projectile(bool direction) :
+    from_player{direction}
+{
+    Assets::apply_texture(sprite, from_player ? player_projectile_file
+			  : enemy_projectile_file, Assets::PROJECTILE);
+}
+
 /* 
  * FUNCTION update(sf::Time &)
  * 
@@ -534,3 +913,14 @@ void Projectile::handle_collision(bool, Info_Strip &)
 {
     removed = true;
 }
+
+/* 
+ * FUNCTION is_from_player()
+ * 
+ * Returns true if the player fired the projectile.
+ */
+
+bool Projectile::is_from_player() const
+{
+    return from_player;
+}
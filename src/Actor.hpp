@@ -19,11 +19,76 @@
 #include <SFML/Graphics.hpp>
 #include "Info_Strip.hpp"
 #include "Controllers.hpp"
+#include "Input_Source.hpp"
+#include "State_Stream.hpp"
+#include <memory>
 #include <sstream>
 #include <cmath>
+#include <random>
 
 class Projectile;
 
+/* CLASS Random_Engine
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * The random numbers of a Field. A mt19937 that counts how many
+ * numbers it has given, so that its state can be saved as the
+ * seed and the count.
+ *
+ * CONSTRUCTORS
+ * Random_Engine(unsigned), the seed
+ *
+ * OPERATIONS
+ * operator(), input none, output result_type
+ * restore, input unsigned, uint64_t, output none
+ * get_draws, input none, output uint64_t
+ *
+ * DATA MEMBERS
+ * mt19937 engine
+ * uint64_t draws
+ */
+
+class Random_Engine
+{
+public:
+    typedef std::mt19937::result_type result_type;
+
+    explicit Random_Engine(unsigned = 0);
+    ~Random_Engine() = default;
+    result_type operator()();
+    void restore(unsigned, uint64_t);
+    uint64_t get_draws() const;
+private:
+    std::mt19937 engine{};
+    uint64_t draws{};
+};
+
+/* STRUCT Difficulty
+ *
+ * DESCRIPTION
+ * The tunable numbers of a game: the size of the enemy swarm,
+ * how often the enemies shoot and how often the boss appears.
+ *
+ * DATA MEMBERS
+ * int enemy_columns
+ * int enemy_rows
+ * int enemy_shot_chance, an enemy shoots one time out of enemy_shot_chance
+ * float enemy_shot_delay, seconds between the shooting attempts
+ * float boss_interval, seconds between the boss appearances
+ */
+
+struct Difficulty
+{
+    int enemy_columns{12};
+    int enemy_rows{4};
+    int enemy_shot_chance{10};
+    float enemy_shot_delay{1.0};
+    float boss_interval{30.0};
+};
+
 /* CLASS Actor
  *
  * PARENT CLASS
@@ -34,16 +99,27 @@ class Projectile;
  * functions used by the child classes and stores
  * their sprites, positions and a few booleans
  * used by the child classes.
+ *
+ * The memory of a deleted actor is kept by its thread for the next
+ * actor of the same size, so that the projectiles, swarms and bosses
+ * made all through a game stop allocating once as many have lived at
+ * once.
  * 
  * CONSTRUCTORS
  * Actor(), default constructor.
  *
  * OPERATIONS
+ * operator new, input size_t, output void *, reuses kept memory
+ * operator delete, input void *, size_t, output none, keeps the memory
+ * reserve, input size_t, size_t, output none (static), keeps memory
+ *     for at least that many actors of a size
  * virtual update, input Time &, output none
  * virtual handle_input, input Event &, output none
- * virtual create_projectile, input vector<unique_ptr<Projectile>> &, output none
+ * virtual create_projectile, input vector<unique_ptr<Projectile>> &, Random_Engine &, output none
  * virtual change_direction, input none, output none
  * virtual handle_collision, input bool, Info_Strip &, output none
+ * virtual save_state, input State_Writer &, output none
+ * virtual load_state, input State_Reader &, output none
  * draw, input RenderWindow &, output none
  * get_position, input none, output Vector2f
  * get_size, input none, output FloatRect
@@ -65,11 +141,17 @@ class Actor
 public:
     Actor() = default;
     virtual ~Actor() = default;
+    static void * operator new(std::size_t);
+    static void operator delete(void *, std::size_t);
+    static void reserve(std::size_t, std::size_t);
     virtual void update(sf::Time &) = 0;
     virtual void handle_input(sf::Event &) {}
-    virtual void create_projectile(std::vector<std::unique_ptr<Projectile>> &) {}
+    virtual void create_projectile(std::vector<std::unique_ptr<Projectile>> &,
+				   Random_Engine &) {}
     virtual void change_direction() {}
     virtual void handle_collision(bool, Info_Strip &) = 0;
+    virtual void save_state(State_Writer &) const;
+    virtual void load_state(State_Reader &);
     virtual void draw(sf::RenderWindow &);
     sf::Vector2f get_position() const;
     sf::FloatRect get_size();
@@ -91,7 +173,8 @@ protected:
  *
  * DESCRIPTION
  * The actor for the game user. Handles movement and shooting
- * for the player. 
+ * for the player. The held keys are read from the input source
+ * every frame, the keyboard unless another source is set.
  * 
  * CONSTRUCTORS
  * Player()
@@ -99,16 +182,18 @@ protected:
  * OPERATIONS
  * update, input Time &, output none
  * handle_input, input Event &, output none
- * create_projectile, input vector<unique_ptr<Projectile>> &, output none
+ * create_projectile, input vector<unique_ptr<Projectile>> &, Random_Engine &, output none
  * handle_collision, input bool, Info_Strip &, output none
+ * save_state, input State_Writer &, output none
+ * load_state, input State_Reader &, output none
+ * set_input, input unique_ptr<Input_Source>, output none
+ * get_keys, input none, output unsigned
  *
  * DATA MEMBERS
- * Texture texture
  * Vector2f direction
  * float projectile_Delay
- * SoundBuffer hit_buffer
- * Sound hit_sound
  * Controllers controllers
+ * unique_ptr<Input_Source> input
  */
 
 class Player : public Actor
@@ -118,20 +203,23 @@ public:
     ~Player() = default;
     void update(sf::Time &) override; 
     void handle_input(sf::Event &) override;
-    void create_projectile(std::vector<std::unique_ptr<Projectile>> &) override;
+    void create_projectile(std::vector<std::unique_ptr<Projectile>> &,
+			   Random_Engine &) override;
     void handle_collision(bool, Info_Strip &) override;
+    void save_state(State_Writer &) const override;
+    void load_state(State_Reader &) override;
     void draw(sf::RenderWindow &) override;
+    void set_input(std::unique_ptr<Input_Source>);
+    unsigned get_keys() const;
 private:
-    sf::Texture texture{};
     sf::Vector2f direction{};
     float projectile_delay{};
     sf::RectangleShape energy_bar{};
     float energy_delay{};
     int energy{50};
     sf::Text energy_text{};
-    sf::SoundBuffer hit_buffer{};
-    sf::Sound hit_sound{};
     Controllers controllers{};
+    std::unique_ptr<Input_Source> input{std::make_unique<Keyboard_Input>()};
 };
 
 /* CLASS Enemy
@@ -145,16 +233,20 @@ private:
  * for the enemies.
  * 
  * CONSTRUCTORS
- * Enemy(float, float, int)
+ * Enemy(float, float, int, Difficulty const &)
  *
  * OPERATIONS
  * update, input Time &, output none
  * handle_input, input Event &, output none
- * create_projectile, input vector<unique_ptr<Projectile>> &, output none
+ * create_projectile, input vector<unique_ptr<Projectile>> &, Random_Engine &, output none
  * handle_collision, input bool, Info_Strip &, output none
+ * save_state, input State_Writer &, output none
+ * load_state, input State_Reader &, output none
+ * get_type, input none, output int
  *
  * DATA MEMBERS
- * Texture texture
+ * int type
+ * Difficulty difficulty
  * float moving_delay
  * float projectile_delay
  * float change_direction_delay
@@ -166,14 +258,19 @@ private:
 class Enemy : public Actor
 {    
 public:
-    Enemy(float, float, int);
+    Enemy(float, float, int, Difficulty const &);
     ~Enemy() = default;
     void update(sf::Time &) override;
-    void create_projectile(std::vector<std::unique_ptr<Projectile>> &) override;
+    void create_projectile(std::vector<std::unique_ptr<Projectile>> &,
+			   Random_Engine &) override;
     void change_direction() override;
     void handle_collision(bool, Info_Strip &) override;
+    void save_state(State_Writer &) const override;
+    void load_state(State_Reader &) override;
+    int get_type() const;
 private:
-    sf::Texture texture{};
+    int type{};
+    Difficulty difficulty{};
     float moving_delay{};
     float projectile_delay{};
     float change_direction_delay{};
@@ -191,14 +288,16 @@ private:
  * and collision with player projectiles.
  * 
  * CONSTRUCTORS
- * Boss_Enemy()
+ * Boss_Enemy(float)
  *
  * OPERATIONS
  * update, input Time &, output none
  * handle_collision, input bool, Info_Strip &, output none
+ * save_state, input State_Writer &, output none
+ * load_state, input State_Reader &, output none
  *
  * DATA MEMBERS
- * Texture texture
+ * float interval
  * float boss_delay
  * int health
  */
@@ -206,12 +305,14 @@ private:
 class Boss_Enemy : public Actor
 {
 public:
-    Boss_Enemy();
+    Boss_Enemy(float);
     ~Boss_Enemy() = default;
     void update(sf::Time &) override;
     void handle_collision(bool, Info_Strip &) override;
+    void save_state(State_Writer &) const override;
+    void load_state(State_Reader &) override;
 private:
-    sf::Texture texture{};
+    float interval{};
     float boss_delay{};
     int health{2}; 
 };
@@ -232,11 +333,10 @@ private:
  * OPERATIONS
  * update, input Time &, output none
  * handle_collision, input bool, Info_Strip &, output none
+ * save_state, input State_Writer &, output none
+ * load_state, input State_Reader &, output none
  *
  * DATA MEMBERS
- * Texture texture
- * Texture broken
- * Texture more_broken
  * int health
  */
 
@@ -247,10 +347,9 @@ public:
     ~Block() = default;
     void update(sf::Time &) override;
     void handle_collision(bool, Info_Strip &) override;
+    void save_state(State_Writer &) const override;
+    void load_state(State_Reader &) override;
 private:
-    sf::Texture texture{};
-    sf::Texture broken{};
-    sf::Texture more_broken{};
     int health{3};
 };
 
@@ -265,17 +364,15 @@ private:
  * 
  * CONSTRUCTORS
  * Projectile(Vector2f, bool)
+ * Projectile(bool), a projectile to load a saved state into, which
+ *     only gets its texture and is not heard
  *
  * OPERATIONS
  * update, input Time &, output none
  * handle_collision, input bool, Info_Strip &, output none
+ * is_from_player, input none, output bool
  *
  * DATA MEMBERS
- * Texture texture
- * SoundBuffer player_buffer
- * SoundBuffer enemy_buffer
- * Sound player_sound
- * Sound enemy_sound
  * bool from_player
  */
 
@@ -283,15 +380,12 @@ class Projectile: public Actor
 {
 public:
     Projectile(sf::Vector2f, bool); 
+    explicit Projectile(bool);
     ~Projectile() = default;
     void update(sf::Time &) override;
     void handle_collision(bool, Info_Strip &) override;
+    bool is_from_player() const;
 private:
-    sf::Texture texture{};
-    sf::SoundBuffer player_buffer{};
-    sf::SoundBuffer enemy_buffer{};
-    sf::Sound player_sound{};
-    sf::Sound enemy_sound{};
     bool from_player{};
 };
 
@@ -0,0 +1,219 @@
+/*
+ * IDENTIFICATION
+ * File name:  Allocation_Hooks.cpp
+ * Type:       Definitions
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Replaces the global operator new and delete, also those with an
+ * alignment, with versions that count every allocation in
+ * Allocations before they use malloc or aligned_alloc and free. Only
+ * linked into the programs, see Allocations.hpp.
+ */
+
+#include "Allocations.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+/*
+ * FUNCTION allocate(size_t)
+ *
+ * Counts and allocates memory. Calls the new handler until there is
+ * memory or there is no handler, as operator new must.
+ */
+
+static void * allocate(size_t size)
+{
+    Allocations::allocated(size);
+
+    if (size == 0)
+	size = 1;
+
+    while (true)
+    {
+	if (void * pointer = malloc(size))
+	    return pointer;
+
+	new_handler handler = get_new_handler();
+	if (handler == nullptr)
+	    throw bad_alloc{};
+	handler();
+    }
+}
+
+/*
+ * FUNCTION allocate_aligned(size_t, align_val_t)
+ *
+ * Counts and allocates memory with a larger alignment than new
+ * gives by itself, for types declared with alignas.
+ */
+
+static void * allocate_aligned(size_t size, align_val_t alignment)
+{
+    Allocations::allocated(size);
+
+    size_t align{max(static_cast<size_t>(alignment), sizeof(void *))};
+
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size = (max<size_t>(size, 1) + align - 1) / align * align;
+
+    while (true)
+    {
+	if (void * pointer = aligned_alloc(align, size))
+	    return pointer;
+
+	new_handler handler = get_new_handler();
+	if (handler == nullptr)
+	    throw bad_alloc{};
+	handler();
+    }
+}
+
+/*
+ * FUNCTION release(void *)
+ *
+ * Counts and frees memory.
+ */
+
+static void release(void * pointer) noexcept
+{
+    if (pointer == nullptr)
+	return;
+
+    Allocations::freed();
+    free(pointer);
+}
+
+void * operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void * operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void * operator new(size_t size, nothrow_t const &) noexcept
+{
+    try
+    {
+	return allocate(size);
+    }
+    catch (...)
+    {
+	return nullptr;
+    }
+}
+
+void * operator new[](size_t size, nothrow_t const &) noexcept
+{
+    try
+    {
+	return allocate(size);
+    }
+    catch (...)
+    {
+	return nullptr;
+    }
+}
+
+void operator delete(void * pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void * pointer, size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer, size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void * pointer, nothrow_t const &) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer, nothrow_t const &) noexcept
+{
+    release(pointer);
+}
+
+void * operator new(size_t size, align_val_t alignment)
+{
+    return allocate_aligned(size, alignment);
+}
+
+void * operator new[](size_t size, align_val_t alignment)
+{
+    return allocate_aligned(size, alignment);
+}
+
+void * operator new(size_t size, align_val_t alignment, nothrow_t const &) noexcept
+{
+    try
+    {
+	return allocate_aligned(size, alignment);
+    }
+    catch (...)
+    {
+	return nullptr;
+    }
+}
+
+void * operator new[](size_t size, align_val_t alignment, nothrow_t const &) noexcept
+{
+    try
+    {
+	return allocate_aligned(size, alignment);
+    }
+    catch (...)
+    {
+	return nullptr;
+    }
+}
+
+void operator delete(void * pointer, align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer, align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void * pointer, size_t, align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer, size_t, align_val_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void * pointer, align_val_t, nothrow_t const &) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void * pointer, align_val_t, nothrow_t const &) noexcept
+{
+    release(pointer);
+}
@@ -0,0 +1,124 @@
+/*
+ * IDENTIFICATION
+ * File name:  Allocations.cpp
+ * Type:       Definitions for module Allocations
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Allocations class which counts the memory
+ * allocations of each thread and can flag allocations where there
+ * should be none.
+ */
+
+#include "Allocations.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+#define reported_violations 20
+
+using namespace std;
+
+thread_local Allocations::Totals Allocations::totals{};
+thread_local Allocations::Mode Allocations::mode{OFF};
+thread_local bool Allocations::reporting{false};
+atomic<uint64_t> Allocations::violations{};
+
+/*
+ * FUNCTION get()
+ *
+ * Returns the counts of this thread since it started.
+ */
+
+Allocations::Totals Allocations::get()
+{
+    return totals;
+}
+
+/*
+ * FUNCTION check(Mode)
+ *
+ * Sets how allocations on this thread are checked from now on.
+ */
+
+void Allocations::check(Mode new_mode)
+{
+    mode = new_mode;
+}
+
+/*
+ * FUNCTION get_mode()
+ *
+ * Returns how allocations on this thread are checked.
+ */
+
+Allocations::Mode Allocations::get_mode()
+{
+    return mode;
+}
+
+/*
+ * FUNCTION get_violations()
+ *
+ * Returns the number of allocations made while checking was on,
+ * on any thread.
+ */
+
+uint64_t Allocations::get_violations()
+{
+    return violations;
+}
+
+/*
+ * FUNCTION allocated(size_t)
+ *
+ * Counts an allocation. Must not allocate itself.
+ */
+
+void Allocations::allocated(size_t size)
+{
+    ++totals.count;
+    totals.bytes += size;
+
+    if (mode != OFF && !reporting)
+	violation(size);
+}
+
+/*
+ * FUNCTION freed()
+ *
+ * Counts a release of memory.
+ */
+
+void Allocations::freed()
+{
+    ++totals.frees;
+}
+
+/*
+ * FUNCTION violation(size_t)
+ *
+ * Reports an allocation made while checking was on. Uses stdio
+ * since it does not allocate for unbuffered stderr.
+ */
+
+void Allocations::violation(size_t size)
+{
+    uint64_t count = ++violations;
+
+    reporting = true;
+
+    if (mode == ABORT)
+    {
+	fprintf(stderr, "Allocation of %zu bytes in the game loop!\n", size);
+	abort();
+    }
+
+    if (count <= reported_violations)
+	fprintf(stderr, "Allocation of %zu bytes in the game loop%s\n", size,
+		count == reported_violations ? ", not reporting more" : "");
+
+    reporting = false;
+}
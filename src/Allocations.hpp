@@ -0,0 +1,86 @@
+/*
+ * IDENTIFICATION
+ * File name:  Allocations.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Allocations class which counts the memory
+ * allocations of each thread and can flag allocations where there
+ * should be none.
+ */
+
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/* CLASS Allocations
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * The counts are only made when the program is linked with
+ * Allocation_Hooks.o, which replaces the global operator new and
+ * delete. Without it every count stays zero, which is the case for
+ * libpsi_env.so since a library should not replace operator new
+ * for the program that loads it.
+ *
+ * While checking is on for a thread, every allocation on it is a
+ * violation. REPORT prints the first violations and counts the
+ * rest, ABORT stops the program at the first one so that a debugger
+ * shows where it came from.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * get, input none, output Totals, the counts of this thread
+ * check, input Mode, output none, turns checking on or off
+ * get_mode, input none, output Mode, how this thread is checked
+ * get_violations, input none, output uint64_t
+ * allocated, input size_t, output none, called by operator new
+ * freed, input none, output none, called by operator delete
+ *
+ * DATA MEMBERS
+ * thread_local Totals totals
+ * thread_local Mode mode
+ * thread_local bool reporting, true while a violation is printed
+ * atomic<uint64_t> violations
+ */
+
+class Allocations
+{
+public:
+    enum Mode { OFF, REPORT, ABORT };
+
+    struct Totals
+    {
+	uint64_t count;
+	uint64_t bytes;
+	uint64_t frees;
+    };
+
+    Allocations() = delete;
+    static Totals get();
+    static void check(Mode);
+    static Mode get_mode();
+    static uint64_t get_violations();
+    static void allocated(std::size_t);
+    static void freed();
+private:
+    static void violation(std::size_t);
+
+    static thread_local Totals totals;
+    static thread_local Mode mode;
+    static thread_local bool reporting;
+    static std::atomic<uint64_t> violations;
+};
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ * IDENTIFICATION
+ * File name:  Assets.cpp
+ * Type:       Definitions for module Assets
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Assets class which loads every texture,
+ * sound and font once and shares it between everything that uses it.
+ */
+
+#include "Assets.hpp"
+#include "Trace.hpp"
+#include "Counters.hpp"
+#include <mutex>
+#include <iomanip>
+#include <array>
+
+#define font_file "fonts/LCD_Solid.ttf"
+
+using namespace std;
+
+atomic<bool> Assets::headless_mode{false};
+shared_mutex Assets::mutex{};
+map<string, Assets::Texture_Entry> Assets::textures{};
+map<string, Assets::Size_Entry> Assets::sizes{};
+map<string, Assets::Sound_Entry> Assets::sound_buffers{};
+unique_ptr<sf::Font> Assets::font{};
+map<unsigned, uint32_t> Assets::glyph_sizes{};
+vector<sf::Sound> Assets::sounds{};
+unsigned Assets::next_sound{};
+
+/*
+ * The owners drawn by each Game_State, used to add up the assets
+ * of a state in the report.
+ */
+static vector<pair<string, uint32_t>> const state_owners
+{
+    {"startscreen", 1u << Assets::STARTSCREEN | 1u << Assets::BUTTON |
+		    1u << Assets::TOP_LIST | 1u << Assets::TEXT_BOX},
+    {"field", 1u << Assets::FIELD | 1u << Assets::PLAYER | 1u << Assets::ENEMY |
+	      1u << Assets::BOSS | 1u << Assets::BLOCK | 1u << Assets::PROJECTILE |
+	      1u << Assets::INFO_STRIP},
+    {"pause", 1u << Assets::PAUSE | 1u << Assets::BUTTON},
+    {"lose", 1u << Assets::LOSE | 1u << Assets::BUTTON | 1u << Assets::TOP_LIST}
+};
+
+/*
+ * FUNCTION set_headless(bool)
+ *
+ * Turns headless mode on or off. Must be called before any
+ * actor is created.
+ */
+
+void Assets::set_headless(bool on)
+{
+    headless_mode = on;
+}
+
+/*
+ * FUNCTION headless()
+ *
+ * Returns true if the game runs without window and sound.
+ */
+
+bool Assets::headless()
+{
+    return headless_mode;
+}
+
+/*
+ * FUNCTION apply_texture(sf::Sprite &, string const &, Owner)
+ *
+ * Gives the sprite the texture loaded from file. In headless mode
+ * only the texture rectangle is set, which is all that is needed
+ * for the sprite bounds.
+ */
+
+void Assets::apply_texture(sf::Sprite & sprite, string const & file, Owner owner)
+{
+    if (headless())
+	sprite.setTextureRect(size(file, owner));
+    else
+	sprite.setTexture(texture(file, owner), true);
+}
+
+/*
+ * FUNCTION play_sound(string const &, Owner)
+ *
+ * Plays the sound loaded from file on the next of 16 sound channels.
+ * Does nothing in headless mode.
+ */
+
+void Assets::play_sound(string const & file, Owner owner)
+{
+    if (headless())
+	return;
+
+    if (sounds.empty())
+	sounds.resize(16);
+
+    sf::Sound & sound = sounds.at(next_sound);
+    next_sound = (next_sound + 1) % sounds.size();
+
+    sound.setBuffer(sound_buffer(file, owner));
+    sound.play();
+    Counters::add(Counters::SOUND_PLAYS);
+}
+
+/*
+ * FUNCTION text(string const &, unsigned, Owner)
+ *
+ * Returns a text in the font of the game, which is loaded on first
+ * use. Headless games create texts too, hence the lock.
+ */
+
+sf::Text Assets::text(string const & content, unsigned character_size, Owner owner)
+{
+    unique_lock<shared_mutex> lock{mutex};
+
+    if (!font)
+    {
+	TRACE_SCOPE("load font");
+	unique_ptr<sf::Font> loaded{make_unique<sf::Font>()};
+	if (!loaded -> loadFromFile(font_file))
+	    throw invalid_argument("Font not found!");
+	font = move(loaded);
+    }
+
+    glyph_sizes[character_size] |= 1u << owner;
+    return sf::Text(content, *font, character_size);
+}
+
+/*
+ * FUNCTION get_stats()
+ *
+ * Returns how many textures, image sizes and sound buffers are
+ * cached. Called from the game thread, like the loading of textures
+ * and sounds.
+ */
+
+Assets::Stats Assets::get_stats()
+{
+    shared_lock<shared_mutex> lock{mutex};
+    return Stats{textures.size(), sizes.size(), sound_buffers.size()};
+}
+
+/*
+ * FUNCTION report(ostream &)
+ *
+ * Writes the bytes of every texture, glyph page and sound buffer,
+ * and the sums per owner and per Game_State. Textures take four
+ * bytes per pixel on the graphics card, sounds two per sample.
+ * Must be called from the game thread.
+ */
+
+void Assets::report(ostream & out)
+{
+    enum Kind { PIXELS, GLYPHS, PCM, KIND_COUNT };
+
+    struct Line
+    {
+	Kind kind;
+	uint64_t bytes;
+	string name;
+	uint32_t owners;
+    };
+
+    vector<Line> lines{};
+    shared_lock<shared_mutex> lock{mutex};
+
+    for (auto && entry : textures)
+    {
+	sf::Vector2u pixels{entry.second.texture -> getSize()};
+	lines.push_back(Line{PIXELS, uint64_t(pixels.x) * pixels.y * 4,
+			     entry.first, entry.second.owners});
+    }
+
+    // Headless games never draw, so they have no glyph pages
+    if (font && !headless())
+	for (auto && entry : glyph_sizes)
+	{
+	    sf::Vector2u pixels{font -> getTexture(entry.first).getSize()};
+	    lines.push_back(Line{GLYPHS, uint64_t(pixels.x) * pixels.y * 4,
+				 "glyphs of size " + to_string(entry.first),
+				 entry.second});
+	}
+
+    for (auto && entry : sound_buffers)
+	lines.push_back(Line{PCM, entry.second.buffer -> getSampleCount() * 2,
+			     entry.first, entry.second.owners});
+
+    auto owner_list = [](uint32_t owners)
+	{
+	    string list{};
+	    for (int owner{}; owner < OWNER_COUNT; ++owner)
+		if (owners & 1u << owner)
+		    list += (list.empty() ? "" : " ") + owner_name(Owner(owner));
+	    return list;
+	};
+
+    auto sums = [&lines](uint32_t owners)
+	{
+	    array<uint64_t, KIND_COUNT> sum{};
+	    for (Line const & line : lines)
+		if (line.owners & owners)
+		    sum[line.kind] += line.bytes;
+	    return sum;
+	};
+
+    auto sum_line = [&out](string const & name, array<uint64_t, KIND_COUNT> const & sum)
+	{
+	    out << left << setw(14) << name << right
+		<< setw(11) << sum[PIXELS] << setw(11) << sum[GLYPHS]
+		<< setw(11) << sum[PCM]
+		<< setw(11) << sum[PIXELS] + sum[GLYPHS] + sum[PCM] << "\n";
+	};
+
+    char const * kind_names[]{"pixels", "glyphs", "pcm"};
+
+    out << "Asset memory\n"
+	<< left << setw(8) << "kind" << right << setw(11) << "bytes" << "  "
+	<< left << setw(32) << "asset" << "owners\n";
+    for (Line const & line : lines)
+	out << left << setw(8) << kind_names[line.kind] << right
+	    << setw(11) << line.bytes << "  "
+	    << left << setw(32) << line.name << owner_list(line.owners) << "\n";
+
+    out << "\n" << left << setw(14) << "owner" << right << setw(11) << "pixels"
+	<< setw(11) << "glyphs" << setw(11) << "pcm" << setw(11) << "total" << "\n";
+    for (int owner{}; owner < OWNER_COUNT; ++owner)
+	sum_line(owner_name(Owner(owner)), sums(1u << owner));
+
+    out << "\n" << left << setw(14) << "state" << right << setw(11) << "pixels"
+	<< setw(11) << "glyphs" << setw(11) << "pcm" << setw(11) << "total" << "\n";
+    for (auto && state : state_owners)
+	sum_line(state.first, sums(state.second));
+
+    out << "\n";
+    sum_line("all", sums(~0u));
+    out << flush;
+}
+
+/*
+ * FUNCTION owner_name(Owner)
+ *
+ * Returns the name of an owner.
+ */
+
+string Assets::owner_name(Owner owner)
+{
+    switch (owner)
+    {
+    case PLAYER:      return "player";
+    case ENEMY:       return "enemy";
+    case BOSS:        return "boss";
+    case BLOCK:       return "block";
+    case PROJECTILE:  return "projectile";
+    case INFO_STRIP:  return "info_strip";
+    case BUTTON:      return "button";
+    case TEXT_BOX:    return "text_box";
+    case TOP_LIST:    return "top_list";
+    case PROFILER:    return "profiler";
+    case STARTSCREEN: return "startscreen";
+    case FIELD:       return "field";
+    case PAUSE:       return "pause";
+    case LOSE:        return "lose";
+    default:          return "unknown";
+    }
+}
+
+/*
+ * FUNCTION texture(string const &, Owner)
+ *
+ * Returns the cached texture, loads it on first use.
+ */
+
+sf::Texture const & Assets::texture(string const & file, Owner owner)
+{
+    Texture_Entry & entry = textures[file];
+
+    if (!entry.texture)
+    {
+	TRACE_SCOPE("load texture");
+	Counters::add(Counters::TEXTURE_LOADS);
+	entry.texture = make_unique<sf::Texture>();
+	if (!entry.texture -> loadFromFile(file))
+	{
+	    textures.erase(file);
+	    throw invalid_argument(file + " not found!");
+	}
+    }
+
+    entry.owners |= 1u << owner;
+    return *entry.texture;
+}
+
+/*
+ * FUNCTION size(string const &, Owner)
+ *
+ * Returns the cached size of an image. Used by headless games which
+ * can run on several threads at once, hence the lock.
+ */
+
+sf::IntRect const & Assets::size(string const & file, Owner owner)
+{
+    {
+	shared_lock<shared_mutex> lock{mutex};
+	auto found = sizes.find(file);
+	if (found != end(sizes))
+	{
+	    found -> second.owners.fetch_or(1u << owner, memory_order_relaxed);
+	    return found -> second.rect;
+	}
+    }
+
+    TRACE_SCOPE("load image size");
+    unique_lock<shared_mutex> lock{mutex};
+    sf::Image image;
+    if (!image.loadFromFile(file))
+	throw invalid_argument(file + " not found!");
+
+    Size_Entry & entry = sizes[file];
+    entry.rect = sf::IntRect(0, 0, image.getSize().x, image.getSize().y);
+    entry.owners |= 1u << owner;
+    return entry.rect;
+}
+
+/*
+ * FUNCTION sound_buffer(string const &, Owner)
+ *
+ * Returns the cached sound buffer, loads it on first use.
+ */
+
+sf::SoundBuffer const & Assets::sound_buffer(string const & file, Owner owner)
+{
+    Sound_Entry & entry = sound_buffers[file];
+
+    if (!entry.buffer)
+    {
+	TRACE_SCOPE("load sound");
+	entry.buffer = make_unique<sf::SoundBuffer>();
+	if (!entry.buffer -> loadFromFile(file))
+	{
+	    sound_buffers.erase(file);
+	    throw invalid_argument(file + " not found!");
+	}
+    }
+
+    entry.owners |= 1u << owner;
+    return *entry.buffer;
+}
@@ -0,0 +1,130 @@
+/*
+ * IDENTIFICATION
+ * File name:  Assets.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Assets class which loads every texture,
+ * sound and font once and shares it between everything that uses it.
+ */
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <string>
+#include <map>
+#include <ostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+
+/* CLASS Assets
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Static cache for textures, sound buffers and the font. In headless
+ * mode nothing is uploaded to the graphics card or played, only the
+ * image sizes are read so that sprites still get correct bounds
+ * for collision control.
+ *
+ * Every asset remembers which kinds of owners asked for it, so that
+ * report can tell how many bytes of pixels, glyph pages and sound
+ * samples each owner and each Game_State holds. An asset shared by
+ * several owners is counted once for each of them, but only once in
+ * the total.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * set_headless, input bool, output none
+ * headless, input none, output bool
+ * apply_texture, input Sprite &, string const &, Owner, output none
+ * play_sound, input string const &, Owner, output none
+ * text, input string const &, unsigned, Owner, output Text with the
+ *     font of the game in the given character size
+ * get_stats, input none, output Stats, the number of cached assets
+ * report, input ostream &, output none
+ * owner_name, input Owner, output string
+ *
+ * DATA MEMBERS
+ * atomic<bool> headless_mode
+ * shared_mutex mutex
+ * map<string, Texture_Entry> textures
+ * map<string, Size_Entry> sizes
+ * map<string, Sound_Entry> sound_buffers
+ * unique_ptr<Font> font
+ * map<unsigned, uint32_t> glyph_sizes, the owners of each character size
+ * vector<Sound> sounds
+ * unsigned next_sound
+ */
+
+class Assets
+{
+public:
+    enum Owner
+    {
+	PLAYER, ENEMY, BOSS, BLOCK, PROJECTILE, INFO_STRIP, BUTTON, TEXT_BOX,
+	TOP_LIST, PROFILER, STARTSCREEN, FIELD, PAUSE, LOSE, OWNER_COUNT
+    };
+
+    struct Stats
+    {
+	std::size_t textures;
+	std::size_t sizes;
+	std::size_t sound_buffers;
+    };
+
+    Assets() = delete;
+    static void set_headless(bool);
+    static bool headless();
+    static void apply_texture(sf::Sprite &, std::string const &, Owner);
+    static void play_sound(std::string const &, Owner);
+    static sf::Text text(std::string const &, unsigned, Owner);
+    static Stats get_stats();
+    static void report(std::ostream &);
+    static std::string owner_name(Owner);
+private:
+    struct Texture_Entry
+    {
+	std::unique_ptr<sf::Texture> texture{};
+	uint32_t owners{};
+    };
+
+    struct Size_Entry
+    {
+	sf::IntRect rect{};
+	std::atomic<uint32_t> owners{};
+    };
+
+    struct Sound_Entry
+    {
+	std::unique_ptr<sf::SoundBuffer> buffer{};
+	uint32_t owners{};
+    };
+
+    static sf::Texture const & texture(std::string const &, Owner);
+    static sf::IntRect const & size(std::string const &, Owner);
+    static sf::SoundBuffer const & sound_buffer(std::string const &, Owner);
+
+    static std::atomic<bool> headless_mode;
+    static std::shared_mutex mutex;
+    static std::map<std::string, Texture_Entry> textures;
+    static std::map<std::string, Size_Entry> sizes;
+    static std::map<std::string, Sound_Entry> sound_buffers;
+    static std::unique_ptr<sf::Font> font;
+    static std::map<unsigned, uint32_t> glyph_sizes;
+    static std::vector<sf::Sound> sounds;
+    static unsigned next_sound;
+};
+
+#endif
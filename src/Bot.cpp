@@ -0,0 +1,79 @@
+/*
+ * IDENTIFICATION
+ * File name:  Bot.cpp
+ * Type:       Definitions for module Bot
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Bot class, an input source
+ * that plays the game by itself.
+ */
+
+#include "Bot.hpp"
+
+using namespace std;
+
+/*
+ * FUNCTION Bot(string const &, unsigned)
+ *
+ * Constructor for Bot. Takes the name of the strategy and
+ * a seed for the random strategy.
+ */
+
+Bot::Bot(string const & strategy_init, unsigned seed) :
+    strategy{strategy_init}, random_engine{seed}
+{
+    if (strategy != "camper" && strategy != "sweeper" && strategy != "random")
+	throw invalid_argument("Unknown bot strategy " + strategy + "!");
+}
+
+/*
+ * FUNCTION next_keys(sf::Time const &)
+ *
+ * Decides which keys to hold during this frame.
+ */
+
+unsigned Bot::next_keys(sf::Time const & delta)
+{
+    delay += delta.asSeconds();
+
+    if (strategy == "camper")
+    {
+	keys = Controllers::SPACE;
+    }
+    else if (strategy == "sweeper")
+    {
+	if (!(keys & Controllers::RIGHT))
+	    keys = Controllers::SPACE | Controllers::LEFT;
+
+	// Turn every two seconds, the player then walks about half the field
+	if (delay >= 2.0)
+	{
+	    keys = Controllers::SPACE |
+		(keys & Controllers::LEFT ? Controllers::RIGHT : Controllers::LEFT);
+	    delay = 0.0;
+	}
+    }
+    else if (delay >= 0.25)
+    {
+	keys = random_engine() & (Controllers::LEFT | Controllers::RIGHT |
+				  Controllers::SPACE | Controllers::SHIFT);
+	delay = 0.0;
+    }
+
+    return keys;
+}
+
+/*
+ * FUNCTION get_strategy()
+ *
+ * Returns the name of the strategy.
+ */
+
+string Bot::get_strategy() const
+{
+    return strategy;
+}
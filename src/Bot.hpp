@@ -0,0 +1,62 @@
+/*
+ * IDENTIFICATION
+ * File name:  Bot.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Bot class, an input source
+ * that plays the game by itself.
+ */
+
+#ifndef BOT_H
+#define BOT_H
+
+#include <SFML/Graphics.hpp>
+#include "Input_Source.hpp"
+#include <string>
+#include <random>
+
+/* CLASS Bot
+ *
+ * PARENT CLASS
+ * Input_Source
+ *
+ * DESCRIPTION
+ * A simple automatic player. The strategy is one of
+ * "camper"  stands still and shoots,
+ * "sweeper" shoots while walking from side to side,
+ * "random"  presses random keys four times a second.
+ *
+ * CONSTRUCTORS
+ * Bot(string const &, unsigned)
+ *
+ * OPERATIONS
+ * next_keys, input Time const &, output unsigned
+ * get_strategy, input none, output string
+ *
+ * DATA MEMBERS
+ * string strategy
+ * mt19937 random_engine
+ * float delay
+ * unsigned keys
+ */
+
+class Bot : public Input_Source
+{
+public:
+    Bot(std::string const &, unsigned);
+    ~Bot() = default;
+    unsigned next_keys(sf::Time const &) override;
+    std::string get_strategy() const;
+private:
+    std::string strategy{};
+    std::mt19937 random_engine{};
+    float delay{};
+    unsigned keys{};
+};
+
+#endif
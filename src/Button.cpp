@@ -14,6 +14,7 @@
 
 #include <SFML/Graphics.hpp>
 #include "Button.hpp"
+#include "Assets.hpp"
 #include "Game.hpp"
 
 #define window_width 1024
@@ -28,7 +29,6 @@ using namespace std;
  * Constructs the Button with a string that will be 
  * the text that is seen on the screen. 
  * Also takes the y-coordinate where the button should be.
- * Loads font from file. 
  *  
  * INPUT
  * string const &: a string with the name of the button.
@@ -37,13 +37,10 @@ using namespace std;
  */
 Button::Button(string const & text, int y)
 {
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
-
-    button_text = sf::Text(text, font, 56);
+    button_text = Assets::text(text, 56, Assets::BUTTON);
     button_text.setPosition(window_width/2 - button_text.getGlobalBounds().width / 2, y);
     
-    warning_text = sf::Text("", font, 15);
+    warning_text = Assets::text("", 15, Assets::BUTTON);
     warning_text.setPosition(window_width / 2, window_height / 2 - 30);
 }
 
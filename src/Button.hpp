@@ -41,7 +41,6 @@ class Game;
  * DATA MEMBERS
  * sf::Text button_text
  * sf::Text warning_text
- * sf::Font font
  *
  */
 class Button
@@ -56,7 +55,6 @@ public:
 protected:
     sf::Text button_text{};
     sf::Text warning_text{};
-    sf::Font font{};
 };
 
 
@@ -123,3 +123,40 @@ bool Controllers::is_moving() const
     else
 	return false;
 }
+
+/*
+ * FUNCTION get_keys()
+ *
+ * Returns the held keys as a bitmask.
+ */
+
+unsigned Controllers::get_keys() const
+{
+    unsigned keys{};
+
+    if (left)
+	keys |= LEFT;
+    if (right)
+	keys |= RIGHT;
+    if (space)
+	keys |= SPACE;
+    if (shift)
+	keys |= SHIFT;
+
+    return keys;
+}
+
+/*
+ * FUNCTION set_keys(unsigned)
+ *
+ * Sets which keys are held from a bitmask, used by bots
+ * that do not send key events.
+ */
+
+void Controllers::set_keys(unsigned keys)
+{
+    left = keys & LEFT;
+    right = keys & RIGHT;
+    space = keys & SPACE;
+    shift = keys & SHIFT;
+}
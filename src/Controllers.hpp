@@ -36,6 +36,11 @@
  * shoot(), input none, output boolean
  * run(), input none, output boolean
  * is_moving(), input none, output boolean
+ * get_keys(), input none, output unsigned
+ * set_keys(), input unsigned, output none
+ *
+ * The held keys can also be read and set as a bitmask of
+ * LEFT, RIGHT, SPACE and SHIFT.
  *
  * DATA MEMBERS
  * bool left
@@ -47,6 +52,8 @@
 class Controllers
 {
 public:
+    enum Keys : unsigned { LEFT = 1, RIGHT = 2, SPACE = 4, SHIFT = 8 };
+
     Controllers();
     ~Controllers() = default;
     sf::Vector2f normalize(const sf::Vector2f &);
@@ -55,6 +62,8 @@ public:
     bool shoot() const;
     bool run() const;
     bool is_moving() const;
+    unsigned get_keys() const;
+    void set_keys(unsigned);
 private:
     bool left{};
     bool right{};
@@ -0,0 +1,161 @@
+/*
+ * IDENTIFICATION
+ * File name:  Counters.cpp
+ * Type:       Definitions for module Counters
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Counters class which counts the work done
+ * each frame, and the Stats_Writer class which saves the counts
+ * to a CSV file.
+ */
+
+#include "Counters.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+thread_local Counters::Values Counters::values{};
+
+/*
+ * --------------------------------------------------
+ * --------------------- COUNTERS -------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION take()
+ *
+ * Returns the counts of this thread and starts over from zero.
+ */
+
+Counters::Values Counters::take()
+{
+    Values taken{values};
+    values.fill(0);
+    return taken;
+}
+
+/*
+ * FUNCTION name(Counter)
+ *
+ * Returns the name of a counter, used as CSV column.
+ */
+
+string Counters::name(Counter counter)
+{
+    switch (counter)
+    {
+    case ACTORS:              return "actors";
+    case PROJECTILES:         return "projectiles";
+    case PAIRS_TESTED:        return "pairs_tested";
+    case PAIRS_HIT:           return "pairs_hit";
+    case COLLISIONS_HANDLED:  return "collisions_handled";
+    case PROJECTILES_SPAWNED: return "projectiles_spawned";
+    case PROJECTILES_ERASED:  return "projectiles_erased";
+    case DRAW_CALLS:          return "draw_calls";
+    case TEXTURE_LOADS:       return "texture_loads";
+    case SOUND_PLAYS:         return "sound_plays";
+    case ALLOCATIONS:         return "allocations";
+    case ALLOCATED_BYTES:     return "allocated_bytes";
+    case FREES:               return "frees";
+    default:                  return "unknown";
+    }
+}
+
+/*
+ * --------------------------------------------------
+ * --------------------- STATS WRITER ---------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Stats_Writer(string const &)
+ *
+ * Constructor for Stats_Writer. Opens the file, writes the header
+ * and starts the writer thread.
+ */
+
+Stats_Writer::Stats_Writer(string const & file) :
+    out{file}
+{
+    if (!out)
+	throw invalid_argument("Could not open " + file + "!");
+
+    out << "frame,frame_ms";
+    for (size_t counter{}; counter < Counters::COUNTER_COUNT; ++counter)
+	out << "," << Counters::name(Counters::Counter(counter));
+    out << "\n";
+
+    writer = thread{&Stats_Writer::run, this};
+}
+
+/*
+ * FUNCTION ~Stats_Writer()
+ *
+ * Destructor for Stats_Writer, writes the remaining rows and stops
+ * the writer thread.
+ */
+
+Stats_Writer::~Stats_Writer()
+{
+    {
+	lock_guard<mutex> lock{rows_mutex};
+	stopping = true;
+    }
+    rows_changed.notify_one();
+    writer.join();
+}
+
+/*
+ * FUNCTION write(uint64_t, float, Counters::Values const &)
+ *
+ * Queues a row for the writer thread.
+ */
+
+void Stats_Writer::write(uint64_t frame, float frame_time,
+			 Counters::Values const & values)
+{
+    {
+	lock_guard<mutex> lock{rows_mutex};
+	rows.push_back(Row{frame, frame_time, values});
+    }
+    rows_changed.notify_one();
+}
+
+/*
+ * FUNCTION run()
+ *
+ * The writer thread. Takes all queued rows at once and writes them
+ * without holding the lock.
+ */
+
+void Stats_Writer::run()
+{
+    deque<Row> taken{};
+    bool done{false};
+
+    while (!done)
+    {
+	{
+	    unique_lock<mutex> lock{rows_mutex};
+	    rows_changed.wait(lock, [this]() { return stopping || !rows.empty(); });
+	    taken.swap(rows);
+	    done = stopping;
+	}
+
+	for (Row const & row : taken)
+	{
+	    out << row.frame << "," << row.frame_time;
+	    for (uint64_t value : row.values)
+		out << "," << value;
+	    out << "\n";
+	}
+	taken.clear();
+    }
+
+    out.flush();
+}
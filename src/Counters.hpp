@@ -0,0 +1,131 @@
+/*
+ * IDENTIFICATION
+ * File name:  Counters.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Counters class which counts the work done
+ * each frame, and the Stats_Writer class which saves the counts
+ * to a CSV file.
+ */
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* CLASS Counters
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Counts how many times things happen, like collision tests or
+ * sounds played, since the counts were last taken. Every thread has
+ * its own counts, so headless games on several threads do not mix.
+ * ACTORS and PROJECTILES are not counted up but set to the number
+ * alive at the last update.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * add, input Counter, uint64_t, output none
+ * set, input Counter, uint64_t, output none
+ * take, input none, output Values, the counts, which are then zeroed
+ * name, input Counter, output string
+ *
+ * DATA MEMBERS
+ * thread_local Values values
+ */
+
+class Counters
+{
+public:
+    enum Counter
+    {
+	ACTORS, PROJECTILES, PAIRS_TESTED, PAIRS_HIT, COLLISIONS_HANDLED,
+	PROJECTILES_SPAWNED, PROJECTILES_ERASED, DRAW_CALLS, TEXTURE_LOADS,
+	SOUND_PLAYS, ALLOCATIONS, ALLOCATED_BYTES, FREES, COUNTER_COUNT
+    };
+
+    using Values = std::array<uint64_t, COUNTER_COUNT>;
+
+    Counters() = delete;
+    static void add(Counter counter, uint64_t count = 1)
+    {
+	values[counter] += count;
+    }
+    static void set(Counter counter, uint64_t count)
+    {
+	values[counter] = count;
+    }
+    static Values take();
+    static std::string name(Counter);
+private:
+    static thread_local Values values;
+};
+
+/* CLASS Stats_Writer
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Writes one CSV row per frame: the frame number, the frame time in
+ * milliseconds and the counters. The rows are written by a thread of
+ * its own so that the game loop never waits for the disk.
+ *
+ * CONSTRUCTORS
+ * Stats_Writer(string const &), the file to write
+ *
+ * OPERATIONS
+ * write, input uint64_t, float, Values const &, output none
+ *
+ * DATA MEMBERS
+ * ofstream out
+ * mutex rows_mutex
+ * condition_variable rows_changed
+ * deque<Row> rows, the rows not yet written
+ * bool stopping
+ * thread writer
+ */
+
+class Stats_Writer
+{
+public:
+    explicit Stats_Writer(std::string const &);
+    ~Stats_Writer();
+    Stats_Writer(Stats_Writer const &) = delete;
+    Stats_Writer & operator=(Stats_Writer const &) = delete;
+    void write(uint64_t, float, Counters::Values const &);
+private:
+    struct Row
+    {
+	uint64_t frame;
+	float frame_time;
+	Counters::Values values;
+    };
+
+    void run();
+
+    std::ofstream out{};
+    std::mutex rows_mutex{};
+    std::condition_variable rows_changed{};
+    std::deque<Row> rows{};
+    bool stopping{false};
+    std::thread writer{};
+};
+
+#endif
@@ -0,0 +1,361 @@
+/*
+ * IDENTIFICATION
+ * File name:  Environment.cpp
+ * Type:       Definitions for module Environment
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Environment class and the C interface
+ * declared in psi_env.h.
+ */
+
+#include "Environment.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#define cell_size 32
+
+using namespace std;
+
+/*
+ * FUNCTION Environment(int, int)
+ *
+ * Creates count headless games and threads - 1 worker threads,
+ * the calling thread steps the first slice itself.
+ */
+
+Environment::Environment(int count, int threads)
+{
+    if (count <= 0)
+	throw invalid_argument("The number of games must be positive!");
+
+    if (threads <= 0)
+	threads = max(thread::hardware_concurrency(), 1u);
+    thread_count = min(threads, count);
+
+    for (int index{}; index < count; ++index)
+    {
+	games.push_back(make_unique<Game>(true));
+	fields.push_back(nullptr);
+	inputs.push_back(nullptr);
+	scores.push_back(0);
+	reset_one(index, index, nullptr);
+    }
+
+    for (int worker{1}; worker < thread_count; ++worker)
+	workers.emplace_back(&Environment::work, this, worker);
+}
+
+/*
+ * FUNCTION ~Environment()
+ *
+ * Stops and joins the worker threads.
+ */
+
+Environment::~Environment()
+{
+    {
+	lock_guard<std::mutex> lock{mutex};
+	stop = true;
+    }
+    start.notify_all();
+
+    for (thread & worker : workers)
+	worker.join();
+}
+
+/*
+ * FUNCTION reset(uint32_t const *, psi_observation *)
+ *
+ * Restarts every game with a new seed.
+ */
+
+void Environment::reset(uint32_t const * seeds, psi_observation * observations)
+{
+    run([&](int index)
+	{
+	    reset_one(index, seeds[index], observations + index);
+	});
+}
+
+/*
+ * FUNCTION reset_one(int, uint32_t, psi_observation *)
+ *
+ * Restarts one game with a new seed.
+ */
+
+void Environment::reset_one(int index, uint32_t seed, psi_observation * observation)
+{
+    unique_ptr<Remote_Input> input{make_unique<Remote_Input>()};
+
+    inputs.at(index) = input.get();
+    fields.at(index) = make_unique<Field>(*games.at(index), seed);
+    fields.at(index) -> set_input(move(input));
+    scores.at(index) = 0;
+
+    if (observation != nullptr)
+	observe(index, *observation);
+}
+
+/*
+ * FUNCTION step(uint8_t const *, psi_observation *, float *, uint8_t *)
+ *
+ * Steps every game one frame with the held keys in actions.
+ */
+
+void Environment::step(uint8_t const * actions, psi_observation * observations,
+		       float * rewards, uint8_t * dones)
+{
+    run([&](int index)
+	{
+	    Field & field = *fields[index];
+
+	    if (!field.is_over())
+	    {
+		sf::Time delta{Field::tick};
+
+		inputs[index] -> set_keys(actions[index]);
+		field.update(delta);
+	    }
+
+	    int score{field.get_score()};
+
+	    if (rewards != nullptr)
+		rewards[index] = score - scores[index];
+	    if (dones != nullptr)
+		dones[index] = field.is_over();
+	    if (observations != nullptr)
+		observe(index, observations[index]);
+
+	    scores[index] = score;
+	});
+}
+
+/*
+ * FUNCTION run(function<void(int)> const &)
+ *
+ * Calls the task for every game, split over the workers and the
+ * calling thread, and waits until all games are done. The first
+ * exception thrown by any thread is thrown again here.
+ */
+
+void Environment::run(function<void(int)> const & new_task)
+{
+    {
+	lock_guard<std::mutex> lock{mutex};
+	task = new_task;
+	failure = nullptr;
+	running = workers.size();
+	++generation;
+    }
+    start.notify_all();
+
+    int count = fields.size();
+
+    try
+    {
+	for (int index{}; index < count / thread_count; ++index)
+	    task(index);
+    }
+    catch (...)
+    {
+	lock_guard<std::mutex> lock{mutex};
+	if (!failure)
+	    failure = current_exception();
+    }
+
+    unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [this]() { return running == 0; });
+
+    if (failure)
+	rethrow_exception(failure);
+}
+
+/*
+ * FUNCTION work(int)
+ *
+ * The loop of a worker thread, waits for a task and runs it on
+ * its own slice of games.
+ */
+
+void Environment::work(int worker)
+{
+    int count = fields.size();
+    unsigned seen{};
+
+    while (true)
+    {
+	{
+	    unique_lock<std::mutex> lock{mutex};
+	    start.wait(lock, [&]() { return stop || generation != seen; });
+	    if (stop)
+		return;
+	    seen = generation;
+	}
+
+	try
+	{
+	    for (int index{worker * count / thread_count};
+		 index < (worker + 1) * count / thread_count; ++index)
+		task(index);
+	}
+	catch (...)
+	{
+	    lock_guard<std::mutex> lock{mutex};
+	    if (!failure)
+		failure = current_exception();
+	}
+
+	{
+	    lock_guard<std::mutex> lock{mutex};
+	    --running;
+	}
+	done.notify_one();
+    }
+}
+
+/*
+ * FUNCTION observe(int, psi_observation &)
+ *
+ * Writes what the game at index looks like into the observation.
+ */
+
+void Environment::observe(int index, psi_observation & observation) const
+{
+    Field & field = *fields.at(index);
+
+    memset(observation.grid, PSI_TYPE_EMPTY, sizeof(observation.grid));
+    observation.entity_count = 0;
+
+    auto add = [&observation](sf::FloatRect const & size, int type)
+	{
+	    int left = max(0, int(size.left) / cell_size);
+	    int top = max(0, int(size.top) / cell_size);
+	    int right = min(PSI_GRID_WIDTH - 1, int(size.left + size.width) / cell_size);
+	    int bottom = min(PSI_GRID_HEIGHT - 1, int(size.top + size.height) / cell_size);
+
+	    for (int y{top}; y <= bottom; ++y)
+		for (int x{left}; x <= right; ++x)
+		    observation.grid[y][x] = type;
+
+	    if (observation.entity_count < PSI_MAX_ENTITIES)
+		observation.entities[observation.entity_count++] =
+		    psi_entity{size.left, size.top, size.width, size.height, type};
+	};
+
+    for (auto && actor : field.get_actors())
+    {
+	int type{PSI_TYPE_BLOCK};
+
+	if (dynamic_cast<Player*>(actor.get()) != nullptr)
+	    type = PSI_TYPE_PLAYER;
+	else if (dynamic_cast<Enemy*>(actor.get()) != nullptr)
+	    type = PSI_TYPE_ENEMY;
+	else if (dynamic_cast<Boss_Enemy*>(actor.get()) != nullptr)
+	    type = PSI_TYPE_BOSS;
+
+	add(actor -> get_size(), type);
+    }
+
+    for (auto && projectile : field.get_projectiles())
+	add(projectile -> get_size(), projectile -> is_from_player() ?
+	    PSI_TYPE_PLAYER_PROJECTILE : PSI_TYPE_ENEMY_PROJECTILE);
+
+    observation.score = field.get_score();
+    observation.lives = field.get_lives();
+    observation.wave = field.get_wave();
+    observation.time = field.get_time();
+}
+
+/*
+ * --------------------------------------------------
+ * ------------------ C INTERFACE -------------------
+ * --------------------------------------------------
+ */
+
+struct psi_env
+{
+    unique_ptr<Environment> environment{};
+    string error{};
+};
+
+/*
+ * FUNCTION call(psi_env *, Function)
+ *
+ * Runs function and turns exceptions into an error code, since
+ * they may not pass through the C interface.
+ */
+
+template <typename Function>
+static int call(psi_env * env, Function function)
+{
+    if (env == nullptr)
+	return -1;
+
+    try
+    {
+	function();
+	env -> error.clear();
+	return 0;
+    }
+    catch (exception const & error)
+    {
+	env -> error = error.what();
+    }
+    catch (...)
+    {
+	env -> error = "Unknown error!";
+    }
+
+    return -1;
+}
+
+extern "C" psi_env * psi_env_create(int count, int threads)
+{
+    try
+    {
+	unique_ptr<psi_env> env{make_unique<psi_env>()};
+	env -> environment = make_unique<Environment>(count, threads);
+	return env.release();
+    }
+    catch (...)
+    {
+	return nullptr;
+    }
+}
+
+extern "C" void psi_env_destroy(psi_env * env)
+{
+    delete env;
+}
+
+extern "C" char const * psi_env_error(psi_env const * env)
+{
+    return env == nullptr ? "No environment!" : env -> error.c_str();
+}
+
+extern "C" int psi_env_reset(psi_env * env, uint32_t const * seeds,
+			     psi_observation * observations)
+{
+    return call(env, [&]() { env -> environment -> reset(seeds, observations); });
+}
+
+extern "C" int psi_env_reset_one(psi_env * env, int index, uint32_t seed,
+				 psi_observation * observation)
+{
+    return call(env, [&]() { env -> environment -> reset_one(index, seed, observation); });
+}
+
+extern "C" int psi_env_step(psi_env * env, uint8_t const * actions,
+			    psi_observation * observations, float * rewards,
+			    uint8_t * dones)
+{
+    return call(env, [&]()
+		{
+		    env -> environment -> step(actions, observations, rewards, dones);
+		});
+}
@@ -0,0 +1,96 @@
+/*
+ * IDENTIFICATION
+ * File name:  Environment.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Environment class which steps a batch
+ * of headless Fields on several threads. It is the C++ side of
+ * the C interface in psi_env.h.
+ */
+
+#ifndef ENVIRONMENT_H
+#define ENVIRONMENT_H
+
+#include "psi_env.h"
+#include "Game.hpp"
+#include "Game_State.hpp"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/* CLASS Environment
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Owns count headless games and a pool of worker threads. Each
+ * worker always steps the same slice of games so no game is
+ * touched by two threads.
+ *
+ * CONSTRUCTORS
+ * Environment(int, int), number of games and threads
+ *
+ * OPERATIONS
+ * reset, input uint32_t const *, psi_observation *, output none
+ * reset_one, input int, uint32_t, psi_observation *, output none
+ * step, input uint8_t const *, psi_observation *, float *, uint8_t *, output none
+ *
+ * DATA MEMBERS
+ * vector<unique_ptr<Game>> games
+ * vector<unique_ptr<Field>> fields
+ * vector<Remote_Input *> inputs, owned by the players of the fields
+ * vector<int> scores
+ * vector<thread> workers
+ * mutex mutex
+ * condition_variable start
+ * condition_variable done
+ * function<void(int)> task
+ * exception_ptr failure
+ * int thread_count
+ * unsigned generation
+ * int running
+ * bool stop
+ */
+
+class Environment
+{
+public:
+    Environment(int, int);
+    ~Environment();
+    Environment(Environment const &) = delete;
+    Environment & operator=(Environment const &) = delete;
+    void reset(uint32_t const *, psi_observation *);
+    void reset_one(int, uint32_t, psi_observation *);
+    void step(uint8_t const *, psi_observation *, float *, uint8_t *);
+private:
+    void run(std::function<void(int)> const &);
+    void work(int);
+    void observe(int, psi_observation &) const;
+
+    std::vector<std::unique_ptr<Game>> games{};
+    std::vector<std::unique_ptr<Field>> fields{};
+    std::vector<Remote_Input *> inputs{};
+    std::vector<int> scores{};
+    std::vector<std::thread> workers{};
+    std::mutex mutex{};
+    std::condition_variable start{};
+    std::condition_variable done{};
+    std::function<void(int)> task{};
+    std::exception_ptr failure{};
+    int thread_count{};
+    unsigned generation{};
+    int running{};
+    bool stop{false};
+};
+
+#endif
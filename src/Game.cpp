@@ -13,32 +13,76 @@
  */
 
 #include "Game.hpp"
+#include "Assets.hpp"
+#include "Trace.hpp"
+#include "Startup.hpp"
+#include <csignal>
+#include <fstream>
+#include <iostream>
 
 #define width 1024
 #define height 768
+#define warm_up_frames 120
+#define reserved_updates 60
+#define title_screen_target 1000
 
 using namespace std;
 
+// Set by F5 or SIGUSR1, the asset report is printed at the end of
+// the frame
+static volatile sig_atomic_t report_requested{0};
+
+#ifdef SIGUSR1
+static void request_report(int)
+{
+    report_requested = 1;
+}
+#endif
+
+string const Game::toplist_file{"Top_List/toplist.bin"};
+string const Game::toplist_text_file{"Top_List/toplist.txt"};
+
 /*
- * FUNCTION Game()
+ * FUNCTION Game(bool)
  *
  * Constructor for Game. Pushes the four different Game States to
- * a vector.
+ * a vector. A headless game only turns on headless mode for the
+ * assets, its Field is created by the caller.
  */
 
-Game::Game()
+Game::Game(bool headless) :
+    toplist{headless ? "" : toplist_file, toplist_text_file}
 {
+    if (headless)
+    {
+	Assets::set_headless(true);
+	return;
+    }
+
+    Startup::mark("Game members constructed");
     states.push_back(make_unique<Startscreen>(*this));
-    states.push_back(make_unique<Field>(*this));
+    Startup::mark("Startscreen constructed");
+    states.push_back(make_field());
+    Startup::mark("Field constructed");
     states.push_back(make_unique<Pause>(*this));
+    Startup::mark("Pause constructed");
     states.push_back(make_unique<Lose>(*this));
+    Startup::mark("Lose constructed");
 }
 
 /*
  * FUNCTION run()
  *
  * Running the actual game. Renders the window, starts background music
- * and starts the game loop.
+ * and starts the game loop. The active state is updated in fixed steps
+ * of Field::tick, as many as the time since the last frame allows.
+ * F3 shows the frame profiler, F4 saves the trace markers to
+ * trace.json when they are compiled in. They are saved at exit too.
+ * F5 or SIGUSR1 prints the memory held by the assets, as does exit.
+ * Frames over the hitch budget save the last frames to a file.
+ * When the startup is timed the times are printed at the first
+ * key or mouse press, or after the first frame if the game should
+ * quit there.
  */
 
 void Game::run()
@@ -49,12 +93,14 @@ void Game::run()
     
     window.setVerticalSyncEnabled(true);
     window.setKeyRepeatEnabled(true);
+    Startup::mark("window created");
 
     // Add window icon
     sf::Image icon;
     if(!icon.loadFromFile("sprites/enemy1.png"))
 	throw invalid_argument("Icon not found!");
     window.setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
+    Startup::mark("icon set");
 
     // Add framerate clock
     sf::Clock clock;
@@ -65,38 +111,163 @@ void Game::run()
 	throw invalid_argument("Background sound not found!");
     music.setLoop(true);
     music.play();
+    Startup::mark("music started");
 
     // Game loop
-    auto delta = clock.restart();
+    sf::Time lag{};
+    sf::Time delta{Field::tick};
+    uint64_t frame{};
+    uint64_t field_frames{};
+    Allocations::Totals allocations{Allocations::get()};
+
+#ifdef SIGUSR1
+    signal(SIGUSR1, request_report);
+#endif
+
+    clock.restart();
 
     while (!quit)
     { 
+	TRACE_SCOPE("frame");
+
+	// Allocations are only checked in the Field once it has warmed
+	// up, and not in the profiler and stats at the end of the frame
+	field_frames = active_state == 1 ? field_frames + 1 : 0;
+	Allocations::check(field_frames > warm_up_frames ? allocation_check
+			   : Allocations::OFF);
+
 	sf::Event event;
-	while (window.pollEvent(event))
+	bool pressed{false};
 	{
-	    switch (event.type) 
+	    TRACE_SCOPE("events");
+	    Profiler::Scope scope{profiler, Profiler::EVENTS};
+
+	    while (window.pollEvent(event))
 	    {
-	    case sf::Event::Closed:
-		quit_game();
-		break;  
-	    default:
-		states.at(active_state) -> handle_input(event);
-		break;
+		pressed = pressed || event.type == sf::Event::KeyPressed ||
+		    event.type == sf::Event::MouseButtonPressed;
+
+		switch (event.type) 
+		{
+		case sf::Event::Closed:
+		    quit_game();
+		    break;  
+		case sf::Event::KeyReleased:
+		    if (event.key.code == sf::Keyboard::F3)
+		    {
+			profiler.toggle();
+			break;
+		    }
+		    if (event.key.code == sf::Keyboard::F4)
+		    {
+			TRACE_DUMP("trace.json");
+			break;
+		    }
+		    if (event.key.code == sf::Keyboard::F5)
+		    {
+			report_requested = 1;
+			break;
+		    }
+		    states.at(active_state) -> handle_input(event);
+		    break;
+		default:
+		    states.at(active_state) -> handle_input(event);
+		    break;
+		}
 	    }
 	}
+
+	if (pressed && Startup::enabled())
+	{
+	    Startup::mark("first input handled");
+	    report_startup();
+	}
 	
 	window.clear();
 
-	states.at(active_state) -> update(delta);
-	
-	delta = clock.restart();
+	// Do not catch up on more than a quarter of a second, the
+	// game stands still while the player is hit
+	lag += clock.restart();
+	if (lag > sf::seconds(0.25))
+	    lag = sf::seconds(0.25);
+
+	while (lag >= Field::tick)
+	{
+	    TRACE_SCOPE("Game_State::update");
+	    states.at(active_state) -> update(delta);
+	    lag -= Field::tick;
+	}
 	
-	states.at(active_state) -> draw(window);
+	{
+	    TRACE_SCOPE("Game_State::draw");
+	    Profiler::Scope scope{profiler, Profiler::DRAW};
+	    states.at(active_state) -> draw(window);
+	    profiler.draw(window);
+	}
+
+	{
+	    TRACE_SCOPE("display");
+	    Profiler::Scope scope{profiler, Profiler::DISPLAY};
+	    window.display();
+	}
+
+	if (frame == 0 && Startup::enabled())
+	{
+	    title_time = Startup::mark("first frame displayed");
+
+	    if (startup_quit)
+	    {
+		report_startup();
+		quit_game();
+	    }
+	}
+
+	Allocations::check(Allocations::OFF);
+	profiler.end_frame();
+
+	// The recording grows here, outside the checked part of the
+	// frame, a second of updates ahead
+	if (recording)
+	    recording -> reserve(reserved_updates);
 
-	window.display();
+	Allocations::Totals now{Allocations::get()};
+	Counters::add(Counters::ALLOCATIONS, now.count - allocations.count);
+	Counters::add(Counters::ALLOCATED_BYTES, now.bytes - allocations.bytes);
+	Counters::add(Counters::FREES, now.frees - allocations.frees);
+	allocations = now;
+
+	Hitch_Recorder::Frame record{frame, profiler.get_frame_time(), {},
+				     states.at(active_state) -> get_keys(),
+				     Counters::take()};
+	for (size_t phase{}; phase < Profiler::PHASE_COUNT; ++phase)
+	    record.phase_times[phase] = profiler.get_phase_time(Profiler::Phase(phase));
+
+	// The first frame includes opening the window
+	if (frame > 0)
+	    hitches.record(record);
+
+	if (stats)
+	    stats -> write(frame, record.frame_time, record.counters);
+	publish_metrics(record);
+	++frame;
+
+	if (report_requested)
+	{
+	    report_requested = 0;
+	    Assets::report(cout);
+	}
     }
     
     window.close();
+    save_recording();
+    stats.reset();
+    metrics.reset();
+    TRACE_DUMP("trace.json");
+    Assets::report(cout);
+
+    if (allocation_check != Allocations::OFF)
+	cout << Allocations::get_violations()
+	     << " allocations in the game loop after warm-up" << endl;
 }
 
 /*
@@ -130,7 +301,8 @@ void Game::quit_game()
 
 void Game::restart()
 {
-    states.at(1) = make_unique<Field>(*this);
+    save_recording();
+    states.at(1) = make_field();
     update_state(0);
 }
 
@@ -145,15 +317,47 @@ void Game::draw_toplist(sf::RenderWindow & window)
     toplist.draw(window);
 }
 
+/*
+ * FUNCTION cycle_toplist()
+ *
+ * Shows the next board of the top list, all time, the last week or
+ * the last day.
+ */
+
+void Game::cycle_toplist()
+{
+    toplist.next_board();
+}
+
 /*
  * FUNCTION update_toplist(string, int)
  *
- * Updates the top list with the users alias and score.
+ * Updates the top list with the users alias and score when a game
+ * is over, after looking up the share of the games before that it
+ * beat, and counts the game. Only called once a game is over, so
+ * only a game that ended is queued for the verifier.
  */
 
 void Game::update_toplist(string alias, int score)
 {
+    beaten = toplist.get_stats().count() > 0 ? toplist.beaten(score) : -1;
     toplist.insert(alias, score);
+    toplist.record_game(score);
+
+    if (recording)
+	submission = alias + '\t' + to_string(score);
+}
+
+/*
+ * FUNCTION get_beaten()
+ *
+ * Returns the share of the games before the last score that it
+ * beat, from 0 to 1, or -1 if it was the first game.
+ */
+
+double Game::get_beaten() const
+{
+    return beaten;
 }
 
 /*
@@ -188,3 +392,215 @@ void Game::handle_alias_input(sf::Event & event)
 {
     namebox.handle_input(event);
 }
+
+/*
+ * FUNCTION record(string const &)
+ *
+ * Records every game from now on to a replay file. The first game is
+ * saved to file, the following to file.2, file.3 and so on.
+ */
+
+void Game::record(string const & file)
+{
+    record_file = file;
+    states.at(1) = make_field();
+}
+
+/*
+ * FUNCTION make_field()
+ *
+ * Creates a new Field, which is recorded if a record file is set.
+ */
+
+unique_ptr<Field> Game::make_field()
+{
+    unique_ptr<Field> field{make_unique<Field>(*this)};
+
+    if (!record_file.empty())
+    {
+	recording = make_unique<Replay>(field -> get_seed(), field -> get_difficulty());
+	field -> set_input(make_unique<Recorder>(make_unique<Keyboard_Input>(),
+						 *recording));
+	field -> record_hashes(*recording);
+    }
+
+    return field;
+}
+
+/*
+ * FUNCTION save_recording()
+ *
+ * Saves the recording of the current Field if anything was played,
+ * and adds its score to the queue of the record file.
+ */
+
+void Game::save_recording()
+{
+    if (!recording || recording -> get_frames().empty())
+	return;
+
+    ++sessions;
+    string file{sessions == 1 ? record_file : record_file + "." + to_string(sessions)};
+    recording -> save(file);
+    recording.reset();
+
+    if (!submission.empty())
+    {
+	ofstream queue{record_file + ".queue", ios::app};
+	queue << submission << '\t' << file << '\n';
+	submission.clear();
+    }
+}
+
+/*
+ * FUNCTION write_stats(string const &)
+ *
+ * Writes the counters of every frame to a CSV file from now on.
+ */
+
+void Game::write_stats(string const & file)
+{
+    stats = make_unique<Stats_Writer>(file);
+}
+
+/*
+ * FUNCTION check_allocations(Allocations::Mode)
+ *
+ * Flags every allocation in the game loop once the Field has run
+ * for warm_up_frames frames.
+ */
+
+void Game::check_allocations(Allocations::Mode mode)
+{
+    allocation_check = mode;
+}
+
+/*
+ * FUNCTION set_hitch_budget(float)
+ *
+ * Sets how many milliseconds a frame may take before the last
+ * frames are saved, 0 turns it off.
+ */
+
+void Game::set_hitch_budget(float budget)
+{
+    hitches.set_budget(budget);
+}
+
+/*
+ * FUNCTION serve_metrics(unsigned short)
+ *
+ * Serves the metrics of the game on a port of localhost.
+ */
+
+void Game::serve_metrics(unsigned short port)
+{
+    metrics = make_unique<Metrics_Server>(port);
+}
+
+/*
+ * FUNCTION use_leaderboard(string const &, unsigned short)
+ *
+ * Sends the scores to a leaderboard server and shows its top list.
+ */
+
+void Game::use_leaderboard(string const & host, unsigned short port)
+{
+    toplist.connect(host, port);
+}
+
+/*
+ * FUNCTION use_shared_scores(string const &)
+ *
+ * Shares the scores with the other games on the machine through a
+ * shared memory segment, and shows its top list.
+ */
+
+void Game::use_shared_scores(string const & name)
+{
+    toplist.share(name);
+}
+
+/*
+ * FUNCTION time_startup(bool)
+ *
+ * Prints the startup times, which must be enabled before the Game
+ * is constructed, at the first input. If quit is true the game
+ * instead prints them after the first frame and quits, so that a
+ * script can start it over and over.
+ */
+
+void Game::time_startup(bool quit)
+{
+    startup_quit = quit;
+}
+
+/*
+ * FUNCTION report_startup()
+ *
+ * Prints the startup times and whether the title screen was shown
+ * within the target.
+ */
+
+void Game::report_startup()
+{
+    Startup::finish(cout);
+    cout << "Title screen after " << title_time << " ms, target "
+	 << title_screen_target << " ms: "
+	 << (title_time <= title_screen_target ? "met" : "missed") << endl;
+}
+
+/*
+ * FUNCTION get_profiler()
+ *
+ * Returns the profiler that times the phases of each frame.
+ */
+
+Profiler & Game::get_profiler()
+{
+    return profiler;
+}
+
+/*
+ * FUNCTION publish_metrics(Hitch_Recorder::Frame const &)
+ *
+ * Hands the numbers of the frame that ended to the metrics server,
+ * if there is one.
+ */
+
+void Game::publish_metrics(Hitch_Recorder::Frame const & record)
+{
+    if (!metrics)
+	return;
+
+    Metrics_Server::Snapshot & snapshot = metrics -> next();
+    Field const * field = dynamic_cast<Field const *>(states.at(1).get());
+
+    snapshot.add_frame_time(record.frame_time);
+    snapshot.actors = record.counters[Counters::ACTORS];
+    snapshot.projectiles = record.counters[Counters::PROJECTILES];
+    snapshot.allocations += record.counters[Counters::ALLOCATIONS];
+    snapshot.allocated_bytes += record.counters[Counters::ALLOCATED_BYTES];
+    snapshot.texture_loads += record.counters[Counters::TEXTURE_LOADS];
+    snapshot.sound_plays += record.counters[Counters::SOUND_PLAYS];
+    snapshot.assets = Assets::get_stats();
+    snapshot.playing = active_state == 1;
+    snapshot.score = field -> get_score();
+    snapshot.wave = field -> get_wave();
+    snapshot.lives = field -> get_lives();
+
+    // The quantiles are only looked up again when a game was added
+    Score_Sketch const & scores{toplist.get_stats()};
+    if (scores.count() != snapshot.games)
+    {
+	for (size_t quantile{}; quantile < snapshot.score_quantiles.size(); ++quantile)
+	    snapshot.score_quantiles[quantile] =
+		scores.quantile(Metrics_Server::score_quantiles[quantile]);
+
+	snapshot.score_bins = scores.get_bins();
+	snapshot.score_sum = scores.get_sum();
+	snapshot.games = scores.count();
+    }
+
+    metrics -> publish();
+}
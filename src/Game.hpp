@@ -20,8 +20,15 @@
 #include "Game_State.hpp"
 #include "Top_List.hpp"
 #include "Text_Box.hpp"
+#include "Replay.hpp"
+#include "Profiler.hpp"
+#include "Counters.hpp"
+#include "Allocations.hpp"
+#include "Hitch_Recorder.hpp"
+#include "Metrics_Server.hpp"
 
 class Game_State;
+class Field;
 
 /* CLASS Game
  *
@@ -29,7 +36,9 @@ class Game_State;
  * None
  * 
  * CONSTRUCTORS
- * Game(), default constructor.
+ * Game(bool), default constructor. A headless game has no states,
+ * window or sound and does not save its top list, it is used
+ * to simulate a Field.
  *
  * OPERATIONS
  * run, input none, output none
@@ -37,39 +46,102 @@ class Game_State;
  * quit_game, input none, output none
  * restart, input none, output none
  * draw_toplist, input RenderWindow &, output none
+ * cycle_toplist, input none, output none, shows the next board
  * update_toplist, input string, int, output none
+ * get_beaten, input none, output double, the share of the games before
+ *     that the last score beat, -1 if there were none
  * draw_textobx, input RenderWindow &, output none
  * get_alias, input none, output string
  * handle_alias_input, input Event &, output none
+ * record, input string const &, output none
+ * get_profiler, input none, output Profiler &
+ * write_stats, input string const &, output none
+ * check_allocations, input Allocations::Mode, output none
+ * set_hitch_budget, input float, output none
+ * serve_metrics, input unsigned short, output none
+ * use_leaderboard, input string const &, unsigned short, output none
+ * use_shared_scores, input string const &, output none
+ * time_startup, input bool, output none
+ *
+ * The top list is saved to toplist_file, and toplist_text_file, the
+ * text file of older versions, is imported when that does not exist.
+ *
+ * A recorded game that ends with a score is added to the queue of
+ * the record file, FILE.queue, as an "alias<TAB>score<TAB>replay"
+ * line, for replay_verifier to check before the score is trusted.
  *
  * DATA MEMBERS
  * vector<unique_ptr<Game_State>> states
  * int active_state
  * bool quit
  * Top_List toplist
+ * double beaten, see get_beaten
  * Text_Box namebox
+ * string record_file
+ * unique_ptr<Replay> recording
+ * string submission, "alias<TAB>score" of the recorded game, if it
+ *     ended with a score
+ * int sessions
+ * Profiler profiler
+ * unique_ptr<Stats_Writer> stats
+ * Allocations::Mode allocation_check
+ * Hitch_Recorder hitches
+ * unique_ptr<Metrics_Server> metrics
+ * bool startup_quit, quit after the first frame when timing the startup
+ * double title_time, ms from process start to the first frame
  */
 
 class Game
 {
 public:
-    Game();
+    static std::string const toplist_file;
+    static std::string const toplist_text_file;
+
+    explicit Game(bool headless = false);
     ~Game() = default;
     void run();
     void update_state(int);
     void quit_game();
     void restart();
     void draw_toplist(sf::RenderWindow &);
+    void cycle_toplist();
     void update_toplist(std::string, int);
+    double get_beaten() const;
     void draw_textbox(sf::RenderWindow &);
     std::string get_alias() const;
     void handle_alias_input(sf::Event &);
+    void record(std::string const &);
+    Profiler & get_profiler();
+    void write_stats(std::string const &);
+    void check_allocations(Allocations::Mode);
+    void set_hitch_budget(float);
+    void serve_metrics(unsigned short);
+    void use_leaderboard(std::string const &, unsigned short);
+    void use_shared_scores(std::string const &);
+    void time_startup(bool);
 private:
+    std::unique_ptr<Field> make_field();
+    void save_recording();
+    void publish_metrics(Hitch_Recorder::Frame const &);
+    void report_startup();
+
     std::vector<std::unique_ptr<Game_State>> states{};
     int active_state{}; //index till active_state;
     bool quit{false};
-    Top_List toplist{"Top_List/toplist.txt"};
+    Top_List toplist{""};
+    double beaten{-1};
     Text_Box namebox{};
+    std::string record_file{};
+    std::unique_ptr<Replay> recording{};
+    std::string submission{};
+    int sessions{};
+    Profiler profiler{};
+    std::unique_ptr<Stats_Writer> stats{};
+    Allocations::Mode allocation_check{Allocations::OFF};
+    Hitch_Recorder hitches{};
+    std::unique_ptr<Metrics_Server> metrics{};
+    bool startup_quit{false};
+    double title_time{};
 };
 
 #endif
@@ -13,9 +13,15 @@
  */
 
 #include "Game_State.hpp"
+#include "Assets.hpp"
+#include "Trace.hpp"
+#include "Counters.hpp"
+#include "Replay.hpp"
+#include "Allocations.hpp"
 
 #define window_width 1024
 #define window_height 768
+#define reserved_projectiles 64
 
 using namespace std;
 
@@ -25,7 +31,6 @@ using namespace std;
  *
  * Constructs the Game_States with a reference to the 
  * current game. 
- * Loads font from file. 
  *  
  * INPUT
  * Game &: a reference to the current game
@@ -33,10 +38,7 @@ using namespace std;
  */
 Game_State::Game_State(Game & game_init) :
     game(game_init)
-{
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
-}
+{}
 
 
 /*
@@ -60,25 +62,24 @@ Game_State::Game_State(Game & game_init) :
 Startscreen::Startscreen(Game & game_init) :
     Game_State(game_init)
 {
-    if(!background.loadFromFile("sprites/startbg.png"))
-	throw invalid_argument("Background not found!");
-    sprite.setTexture(background);
+    Assets::apply_texture(sprite, "sprites/startbg.png", Assets::STARTSCREEN);
 
     
     buttons.push_back( make_unique<Start_Button> ("1-PLAYER", window_height/2));
     buttons.push_back( make_unique<Quit_Button>  ("QUIT", window_height/2 + 80)); 
 
     
-    version = sf::Text("v1.0", font, 25);
+    version = Assets::text("v1.0", 25, Assets::STARTSCREEN);
     version.setPosition(window_width - 200, window_height - 50);
     
-    madeby = sf::Text("Made by:\nKarl Palm\nAlexander Nikonoff"
-		      "\nFrida Flodin\nAlexander Westlund", font, 16);
+    madeby = Assets::text("Made by:\nKarl Palm\nAlexander Nikonoff"
+			  "\nFrida Flodin\nAlexander Westlund", 16, Assets::STARTSCREEN);
     madeby.setPosition(125, window_height - 100);
 
-    controllerinfo = sf::Text("CONTROLLERS\n"
+    controllerinfo = Assets::text("CONTROLLERS\n"
 			      "LEFT: Move left\nRIGHT: Move right\n"
-			     "SPACE: Shoot\nLSHIFT: Run\nP: Pause", font, 16);
+			     "SPACE: Shoot\nLSHIFT: Run\nP: Pause"
+			     "\nF3: Frame times\nUP/DOWN: Top lists", 16, Assets::STARTSCREEN);
     controllerinfo.setPosition(125, window_height/2);
 }
 
@@ -111,7 +112,7 @@ void Startscreen::draw(sf::RenderWindow & window)
  * FUNCTION handle_input(sf::Event &)
  *
  * Takes care of user input like if the user have entered an alias
- * or pressed a button.
+ * or pressed a button. UP and DOWN show the next top list.
  *
  * INPUT: passes a sf::Event on to the components handle_input
  *
@@ -124,6 +125,10 @@ void Startscreen::handle_input(sf::Event & event)
 	button -> handle_input(event, game);
     }
 
+    if (event.type == sf::Event::KeyPressed &&
+	(event.key.code == sf::Keyboard::Up || event.key.code == sf::Keyboard::Down))
+	game.cycle_toplist();
+
     game.handle_alias_input(event);
 }
 
@@ -134,60 +139,351 @@ void Startscreen::handle_input(sf::Event & event)
  */
 
 /*
- * CONSTRUCTOR Field(Game &) 
+ * CONSTRUCTOR Field(Game &, unsigned, Difficulty const &) 
  *
  * Loads the background file to the sprite. 
  * Creates all the actors on the Field and push them to the actor vector
- *  
+ * The texts are not laid out in headless mode since that needs
+ * the font glyphs on the graphics card.
  *
- * INPUT: a Game reference that base class Game_State saves as a member
+ * INPUT: a Game reference that base class Game_State saves as a member,
+ *        the seed for the random numbers and the difficulty
  *
  * USES: help functions make_blocks() and make_enemies() 
  */
-Field::Field(Game & game_init) :
-    Game_State(game_init)
+Field::Field(Game & game_init, unsigned seed_init, Difficulty const & difficulty_init) :
+    Game_State(game_init), seed{seed_init}, difficulty{difficulty_init},
+    random_engine{seed_init}
 {
-    if(!background.loadFromFile("sprites/mbacken.png"))
-	throw invalid_argument("Background not found!");
-    sprite.setTexture(background);
+    Assets::apply_texture(sprite, "sprites/mbacken.png", Assets::FIELD);
 
     actors.push_back(make_unique<Player>());
-    actors.push_back(make_unique<Boss_Enemy>());
+    actors.push_back(make_unique<Boss_Enemy>(difficulty.boss_interval));
     make_enemies();
     make_blocks();
 
-    FPS_text = sf::Text("FPS: __", font, 20);
-    FPS_text.setPosition(150, window_height - 20);
-    FPS_text.setOrigin(FPS_text.getLocalBounds().width / 2,
-		       FPS_text.getLocalBounds().height / 2);
+    // Shots do not allocate, unless more are in the air than ever,
+    // and neither does a new boss, which is made before the old one
+    // is deleted
+    projectiles.reserve(reserved_projectiles);
+    Actor::reserve(sizeof(Projectile), reserved_projectiles);
+    Actor::reserve(sizeof(Boss_Enemy), 1);
+
+    if (Assets::headless())
+	return;
 
-    energy_text = sf::Text("ENERGY", font, 20);
+    energy_text = Assets::text("ENERGY", 20, Assets::FIELD);
     energy_text.setPosition(window_width/2, 10);
     energy_text.setOrigin(energy_text.getLocalBounds().width / 2,
 			  energy_text.getLocalBounds().height / 2);
 }
 
+/*
+ * The Field is always updated in steps of 1/60 second, which makes
+ * a game with the same seed and keys play out the same way.
+ */
+sf::Time const Field::tick{sf::microseconds(16667)};
+
+/*
+ * FUNCTION is_over() 
+ *
+ * Returns true when the player has lost the game.
+ */
+bool Field::is_over() const
+{
+    return over;
+}
+
+/*
+ * FUNCTION get_seed() 
+ *
+ * Returns the seed of the random numbers.
+ */
+unsigned Field::get_seed() const
+{
+    return seed;
+}
+
+/*
+ * FUNCTION get_difficulty() 
+ *
+ * Returns the difficulty.
+ */
+Difficulty Field::get_difficulty() const
+{
+    return difficulty;
+}
+
+/*
+ * FUNCTION get_score() 
+ *
+ * Returns the current score.
+ */
+int Field::get_score() const
+{
+    return strip.get_score();
+}
+
+/*
+ * FUNCTION get_wave() 
+ *
+ * Returns the number of enemy swarms created so far.
+ */
+int Field::get_wave() const
+{
+    return wave;
+}
+
+/*
+ * FUNCTION get_time() 
+ *
+ * Returns the number of seconds played.
+ */
+float Field::get_time() const
+{
+    return game_time;
+}
+
+/*
+ * FUNCTION get_lives() 
+ *
+ * Returns the number of lives left.
+ */
+int Field::get_lives() const
+{
+    return strip.get_lives();
+}
+
+/*
+ * FUNCTION set_input(unique_ptr<Input_Source>) 
+ *
+ * Lets something else than the keyboard play, for example a bot
+ * or a recording.
+ *
+ * USES: 
+ * Function: Player::set_input(unique_ptr<Input_Source>)
+ */
+void Field::set_input(unique_ptr<Input_Source> input)
+{
+    for (auto && actor : actors)
+    {
+	Player * temp = dynamic_cast<Player*>( actor.get() );
+
+	if (temp != nullptr)
+	    temp -> set_input(move(input));
+    }
+}
+
+/*
+ * FUNCTION get_keys() 
+ *
+ * Returns the keys the player held in the last update.
+ */
+unsigned Field::get_keys() const
+{
+    for (auto && actor : actors)
+    {
+	Player * temp = dynamic_cast<Player*>( actor.get() );
+
+	if (temp != nullptr)
+	    return temp -> get_keys();
+    }
+
+    return 0;
+}
+
+/*
+ * FUNCTION get_actors() 
+ *
+ * Returns the actors for reading, used by the bot environment.
+ */
+vector<unique_ptr<Actor>> const & Field::get_actors() const
+{
+    return actors;
+}
+
+/*
+ * FUNCTION get_projectiles() 
+ *
+ * Returns the projectiles for reading, used by the bot environment.
+ */
+vector<unique_ptr<Projectile>> const & Field::get_projectiles() const
+{
+    return projectiles;
+}
+
+
+/*
+ * FUNCTION save_state() 
+ *
+ * Returns everything that decides how the game goes on: the random
+ * numbers, timers, score, lives, actors and projectiles. The seed and
+ * difficulty are not included, a state can only be loaded by a Field
+ * with the same seed and difficulty.
+ *
+ * USES: 
+ * Function: Actor::save_state(State_Writer &)
+ * Function: Info_Strip::save_state(State_Writer &)
+ */
+string Field::save_state() const
+{
+    State_Writer writer{};
+
+    write_state(writer);
+    return writer.get_data();
+}
+
+
+/*
+ * FUNCTION state_hash() 
+ *
+ * Returns a 32 bit FNV-1a hash of the state save_state returns.
+ * Two Fields that played the same keys have the same hash after
+ * every update, so the first update where they differ is found by
+ * comparing them. The state is written to a writer that only
+ * hashes, so that the game loop does not allocate.
+ */
+uint32_t Field::state_hash() const
+{
+    State_Writer writer{true};
+
+    write_state(writer);
+    return writer.get_hash();
+}
+
+
+/*
+ * FUNCTION record_hashes(Replay &) 
+ *
+ * Adds the state hash to the replay after every update that ends
+ * one of its hash intervals.
+ */
+void Field::record_hashes(Replay & replay)
+{
+    recording = &replay;
+}
+
+
+/*
+ * FUNCTION write_state(State_Writer &) 
+ *
+ * Writes the state of save_state.
+ */
+void Field::write_state(State_Writer & writer) const
+{
+    writer.write(random_engine.get_draws());
+    writer.write_float(projectile_delay);
+    writer.write(wave);
+    writer.write_float(game_time);
+    writer.write(over);
+    strip.save_state(writer);
+
+    writer.write(actors.size());
+    for (auto && actor : actors)
+    {
+	Enemy * enemy = dynamic_cast<Enemy*>(actor.get());
+
+	if (dynamic_cast<Player*>(actor.get()) != nullptr)
+	    writer.write(0);
+	else if (enemy != nullptr)
+	    writer.write(1 + (enemy -> get_type() << 2));
+	else if (dynamic_cast<Boss_Enemy*>(actor.get()) != nullptr)
+	    writer.write(2);
+	else
+	    writer.write(3);
+
+	actor -> save_state(writer);
+    }
+
+    writer.write(projectiles.size());
+    for (auto && projectile : projectiles)
+    {
+	writer.write(projectile -> is_from_player());
+	projectile -> save_state(writer);
+    }
+}
+
+
+/*
+ * FUNCTION load_state(string const &) 
+ *
+ * Replaces the game with a state from save_state. The player keeps
+ * its input source.
+ *
+ * USES: 
+ * Function: Actor::load_state(State_Reader &)
+ * Function: Info_Strip::load_state(State_Reader &)
+ */
+void Field::load_state(string const & state)
+{
+    State_Reader reader{state};
+    unique_ptr<Actor> player{};
+
+    for (auto && actor : actors)
+	if (dynamic_cast<Player*>(actor.get()) != nullptr)
+	    player = move(actor);
+
+    random_engine.restore(seed, reader.read());
+    projectile_delay = reader.read_float();
+    wave = reader.read();
+    game_time = reader.read_float();
+    over = reader.read();
+    strip.load_state(reader);
+
+    actors.clear();
+    for (uint64_t count = reader.read(); count > 0; --count)
+    {
+	uint64_t kind = reader.read();
+
+	if (kind == 0)
+	    actors.push_back(player ? move(player) : make_unique<Player>());
+	else if ((kind & 3) == 1)
+	    actors.push_back(make_unique<Enemy>(0, 0, kind >> 2, difficulty));
+	else if (kind == 2)
+	    actors.push_back(make_unique<Boss_Enemy>(difficulty.boss_interval));
+	else
+	    actors.push_back(make_unique<Block>(0, 0));
+
+	actors.back() -> load_state(reader);
+    }
+
+    projectiles.clear();
+    for (uint64_t count = reader.read(); count > 0; --count)
+    {
+	bool from_player = reader.read();
+	projectiles.push_back(make_unique<Projectile>(from_player));
+	projectiles.back() -> load_state(reader);
+    }
+}
+
 
 /*
  * FUNCTION make_enemies() 
  *
  * Help function to create all the enemies on the field
  * Pushes the enemies to the actors vector
+ * The size of the swarm is decided by the difficulty
  *
  */
 void Field::make_enemies()
 {
-    int columns{12};
-    int rows{4};
+    TRACE_SCOPE("Field::make_enemies");
+    TRACE_INSTANT("enemy wave");
+
+    int columns{difficulty.enemy_columns};
+    int rows{difficulty.enemy_rows};
     
     for (int column_count{}; column_count < columns; column_count++)
     {
 	for (int row_count{}; row_count < rows; row_count++)
 	{
 	    actors.push_back(make_unique<Enemy>( (column_count + 1) * 50 + 40,
-						 100 + row_count * 75, row_count + 1) );
+						 100 + row_count * 75, row_count + 1,
+						 difficulty) );
 	}
     }
+
+    ++wave;
 }
 
 
@@ -244,8 +540,8 @@ void Field::draw(sf::RenderWindow & window)
 {
     window.draw(sprite);
     strip.draw(window);
-    window.draw(FPS_text);
     window.draw(energy_text);
+    Counters::add(Counters::DRAW_CALLS, 2 + actors.size() + projectiles.size());
     
     for (auto && actor : actors)
 	actor -> draw(window);
@@ -266,6 +562,7 @@ void Field::draw(sf::RenderWindow & window)
  *
  *
  * USES: 
+ * Function: projectile_update(sf::Time &)
  * Function: actor_update(sf::Time &)
  * Function: make_enemies_shoot()
  * Function: collision_controll()
@@ -276,37 +573,70 @@ void Field::update(sf::Time & delta)
 {
     
     projectile_delay += delta.asSeconds();
+    game_time += delta.asSeconds();
 
-    // Measure FPS
+    TRACE_SCOPE("Field::update");
+    Profiler & profiler{game.get_profiler()};
+    
     {
-	frame_delay += delta.asMilliseconds();
-	++frame_counter;
+	Profiler::Scope scope{profiler, Profiler::PROJECTILES};
+	projectile_update(delta);
+    }
 
-	if(frame_delay >= 1000)
-	{
-	    FPS = frame_counter / (frame_delay / 1000);
-	    frame_counter = 0;
-	    frame_delay = 0;
-	    FPS_text.setString("FPS: " + to_string(FPS));
-	    FPS_text.setOrigin(FPS_text.getLocalBounds().width/2,
-			       FPS_text.getLocalBounds().height/2);
-	}
+    {
+	Profiler::Scope scope{profiler, Profiler::ACTORS};
+	actor_update(delta);
     }
     
-    // Update projectiles and remove projectiles if hit, loop in reverse 
+    {
+	Profiler::Scope scope{profiler, Profiler::SHOOTING};
+	make_enemies_shoot();
+    }
+
+    {
+	Profiler::Scope scope{profiler, Profiler::COLLISION};
+	collision_control();
+    }
+
+    strip.update();
+
+    if (recording && recording -> hash_due())
+	recording -> add_hash(state_hash());
+
+    Counters::set(Counters::ACTORS, actors.size());
+    Counters::set(Counters::PROJECTILES, projectiles.size());
+}
+
+
+/*
+ * FUNCTION projectile_update(sf::Time &) 
+ *
+ * Help function that updates all projectiles and removes the ones
+ * that have hit something or left the screen.
+ *
+ * INPUT: 
+ * sf::Time & 
+ *
+ *
+ * USES: 
+ * Function: Actor::update()
+ *
+ */
+void Field::projectile_update(sf::Time & delta)
+{
+    TRACE_SCOPE("projectiles");
+
+    // Loop in reverse so that erasing does not skip a projectile
     for (int index{(int)projectiles.size() - 1}; index >= 0; --index)
     {
 	projectiles.at(index) -> update(delta);
 	
 	if (projectiles.at(index) -> removed)
+	{
 	    projectiles.erase(projectiles.begin() + index);
+	    Counters::add(Counters::PROJECTILES_ERASED);
+	}
     }
-
-    actor_update(delta);
-    
-    make_enemies_shoot();
-    collision_control();
-    strip.update();
 }
 
 
@@ -330,19 +660,21 @@ void Field::update(sf::Time & delta)
  */
 void Field::actor_update(sf::Time & delta)
 {
+	TRACE_SCOPE("Field::actor_update");
+
 	int enemy_counter{};
 	bool border_hit{false};
 
 	for (auto && actor : actors)
 	{
 	    actor -> update(delta);
-	    actor -> create_projectile(projectiles);
+	    actor -> create_projectile(projectiles, random_engine);
 	
 	    if (actor -> hit_border)
 		border_hit = true;
 
 	    if (actor -> make_new_boss)
-		actor = make_unique<Boss_Enemy>();
+		actor = make_unique<Boss_Enemy>(difficulty.boss_interval);
 	
 	    Enemy * temp = dynamic_cast<Enemy*>(actor.get());
 	
@@ -387,6 +719,8 @@ void Field::actor_update(sf::Time & delta)
  */
 void Field::make_enemies_shoot()
 {
+    TRACE_SCOPE("Field::make_enemies_shoot");
+
     int index{};
     bool first_enemy{true};
     sf::Vector2f prev_enemy_pos{};
@@ -434,28 +768,35 @@ void Field::make_enemies_shoot()
  * USES: 
  * Function: Actor::get_size
  * Function: Actor::handle_collision
- * Function: Game::update_state
- * Function: Game::update_toplist
- * Function: Game::get_alias
- * Function: Info_Strip::update_score
+ * Function: end_game()
  *
  */
 void Field::collision_control()
 {
+    TRACE_SCOPE("Field::collision_control");
+
+    size_t projectile_count{projectiles.size()};
+    size_t actor_count{actors.size()};
+
+    // Every pair is tested, in both orders within the same vector
+    Counters::add(Counters::PAIRS_TESTED,
+		  projectile_count * actor_count +
+		  actor_count * (actor_count - 1) +
+		  projectile_count * (projectile_count - 1));
+
     // Projectiles vs. Actors
     
     for (auto && projectile : projectiles)
 	for (auto && actor : actors)
 	    if (projectile -> get_size().intersects(actor -> get_size()))
 	    {
+		Counters::add(Counters::PAIRS_HIT);
+		Counters::add(Counters::COLLISIONS_HANDLED, 2);
 		actor -> handle_collision(false, strip);
 		projectile -> handle_collision(false, strip);
 
-		if (!(actor -> alive))
-		{
-		    game.update_state(3);
-		    game.update_toplist(game.get_alias(), strip.update_score(0));
-		}
+		if (!(actor -> alive) && !over)
+		    end_game();
 	    }
 
     // Actors vs. Actors
@@ -465,13 +806,12 @@ void Field::collision_control()
 	    if (actor_one != actor_two &&
 		actor_one -> get_size().intersects(actor_two -> get_size()))
 	    {
+		Counters::add(Counters::PAIRS_HIT);
+		Counters::add(Counters::COLLISIONS_HANDLED);
 		actor_one -> handle_collision(true, strip);
 
-		if (!(actor_one -> alive))
-		{
-		    game.update_state(3);
-		    game.update_toplist(game.get_alias(), strip.update_score(0));
-		}
+		if (!(actor_one -> alive) && !over)
+		    end_game();
 	    }
 
     // Projectiles vs. Projectiles
@@ -480,16 +820,48 @@ void Field::collision_control()
 	for (auto && projectile_two : projectiles)
 	    if (projectile_one != projectile_two &&
 		projectile_one -> get_size().intersects(projectile_two -> get_size()))
+	    {
+		Counters::add(Counters::PAIRS_HIT);
+		Counters::add(Counters::COLLISIONS_HANDLED);
 		projectile_one -> handle_collision(false, strip);
+	    }
     
 }
 
 
+/*
+ * FUNCTION end_game() 
+ *
+ * Ends the game once the player is no longer alive, shows that it
+ * is lost and saves the score. Saving the score may allocate, which
+ * is not checked, since the game loop ends here.
+ *
+ * USES: 
+ * Function: Game::update_state
+ * Function: Game::update_toplist
+ * Function: Game::get_alias
+ * Function: Info_Strip::update_score
+ *
+ */
+void Field::end_game()
+{
+    Allocations::Mode checked{Allocations::get_mode()};
+    Allocations::check(Allocations::OFF);
+
+    over = true;
+    game.update_state(3);
+    game.update_toplist(game.get_alias(), strip.update_score(0));
+
+    Allocations::check(checked);
+}
+
+
 /*
  * FUNCTION handle_input(sf::Event &) 
  *
  * This function handles the user input.
- * If the key 'P' is pressed the Game_State changes to Pause
+ * If the key 'P' is pressed the Game_State changes to Pause. The
+ * score is only saved when the game is over, not when paused.
  *
  *
  * INPUT: 
@@ -498,10 +870,7 @@ void Field::collision_control()
  *
  * USES: 
  * Function: Actor::handle_input
- * Function: Game::update_toplist
  * Function: Game::update_state
- * Function: Game::get_alias
- * Function: Info_Strip::update_score
  *
  *
  */
@@ -514,10 +883,7 @@ void Field::handle_input(sf::Event & event)
     {
     case sf::Keyboard::P:
 	if(event.type == sf::Event::KeyReleased)
-	{
-	    game.update_toplist(game.get_alias(), strip.update_score(0));
 	    game.update_state(2);
-	}
 	break; 
     default:
 	break;
@@ -541,9 +907,7 @@ void Field::handle_input(sf::Event & event)
 Pause::Pause(Game & game_init) :
     Game_State(game_init)
 {
-    if(!background.loadFromFile("sprites/startbg.png"))
-	throw invalid_argument("Background not found!");
-    sprite.setTexture(background);
+    Assets::apply_texture(sprite, "sprites/startbg.png", Assets::PAUSE);
 
     buttons.push_back( make_unique< Resume_Button >  ("CONTINUE", window_height/2) );
     buttons.push_back( make_unique< Restart_Button > ("RESTART", window_height/2 + 100) );
@@ -615,17 +979,12 @@ void Pause::handle_input(sf::Event & event)
 Lose::Lose(Game & game_init) :
     Game_State(game_init)
 {
-    if(!background.loadFromFile("sprites/startbg.png"))
-	throw invalid_argument("Background not found!");
-    sprite.setTexture(background);
+    Assets::apply_texture(sprite, "sprites/startbg.png", Assets::LOSE);
 
     buttons.push_back( make_unique<Restart_Button> ("RESTART", window_height/2) );
     buttons.push_back( make_unique<Quit_Button>    ("QUIT", window_height/2 + 100) );
 
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
-
-    lose_text = sf::Text("YOU LOSE!", font, 60);
+    lose_text = Assets::text("YOU LOSE!", 60, Assets::LOSE);
     lose_text.setFillColor(sf::Color::Red);
     lose_text.setPosition(window_width/2, window_height/2 - 60);
     sf::FloatRect textRect = lose_text.getLocalBounds();
@@ -638,7 +997,9 @@ Lose::Lose(Game & game_init) :
  *
  * Draws the background on window and calls
  * the buttons draw-function.
- * Also calls the draw_toplist-function in Game
+ * Also calls the draw_toplist-function in Game, and shows the share
+ * of the games before that the score beat, laid out again only when
+ * it changes.
  *
  * INPUT: 
  * sf::RenderWindow & 
@@ -660,6 +1021,22 @@ void Lose::draw(sf::RenderWindow & window)
     
     game.draw_toplist(window);
     window.draw(lose_text);
+
+    double beaten{game.get_beaten()};
+    int percent{beaten < 0 ? -1 : int(beaten * 100)};
+
+    if (percent != beaten_percent || beaten_text.getString().isEmpty())
+    {
+	beaten_percent = percent;
+	beaten_text = Assets::text(percent < 0 ? "FIRST GAME ON RECORD"
+				   : "YOU BEAT " + to_string(percent) + "% OF ALL GAMES",
+				   20, Assets::LOSE);
+	sf::FloatRect textRect = beaten_text.getLocalBounds();
+	beaten_text.setOrigin(textRect.width/2, textRect.height/2);
+	beaten_text.setPosition(window_width/2, window_height/2 - 130);
+    }
+
+    window.draw(beaten_text);
 }
 
 
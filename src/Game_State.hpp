@@ -24,6 +24,9 @@
 #include "Button.hpp"
 #include "Info_Strip.hpp"
 #include <vector>
+#include <random>
+
+class Replay;
 
 class Game;
 
@@ -43,13 +46,12 @@ class Game;
  * virtual void draw,         INPUT: sf::RenderWindow &
  * virtual void update,       INPUT: sf::Time &
  * virtual void handle_input, INPUT: sf::Event &
+ * virtual unsigned get_keys, INPUT: none, the keys held by the player
  *
  * DATA MEMBERS
  * Game & game
  * vector<std::unique_ptr<Button>> buttons
  * Sprite  sprite{}
- * Font    font{}
- * Texture background{}
  *
  */
 
@@ -61,12 +63,11 @@ public:
     virtual void draw(sf::RenderWindow &) = 0;
     virtual void update(sf::Time &){}; 
     virtual void handle_input(sf::Event &) = 0;
+    virtual unsigned get_keys() const { return 0; }
 protected:
     Game & game;
     std::vector<std::unique_ptr<Button>> buttons{}; 
     sf::Sprite  sprite{};
-    sf::Font    font{};
-    sf::Texture background{};
 };
 
 /* CLASS Startscreen
@@ -114,49 +115,95 @@ private:
  * Represents the game field  
  * 
  * CONSTRUCTORS	
- * Field(Game &) INPUT: a reference to the current game
+ * Field(Game &, unsigned, Difficulty const &) INPUT: a reference to the
+ *     current game, the random seed and the difficulty
  *
  * OPERATIONS
  * virtual void draw,         INPUT: sf::RenderWindow &
  * virtual void update,       INPUT: sf::Time &
  * virtual void handle_input, INPUT: sf::Event &
+ * static Time tick, the length of one update, 1/60 second
+ * bool is_over,              INPUT: none
+ * unsigned get_seed,         INPUT: none
+ * Difficulty get_difficulty, INPUT: none
+ * int get_score,             INPUT: none
+ * int get_wave,              INPUT: none
+ * float get_time,            INPUT: none
+ * int get_lives,             INPUT: none
+ * void set_input,            INPUT: unique_ptr<Input_Source>
+ * unsigned get_keys,         INPUT: none
+ * get_actors,                INPUT: none
+ * get_projectiles,           INPUT: none
+ * string save_state,         INPUT: none
+ * void load_state,           INPUT: string const &, a state from save_state
+ * uint32_t state_hash,       INPUT: none, a hash of save_state
+ * void record_hashes,        INPUT: Replay &, the replay that gets the
+ *                            state hash every hash interval
  * 
  *
  * DATA MEMBERS
+ * unsigned seed
+ * Difficulty difficulty
+ * Random_Engine random_engine
+ * int wave
+ * float game_time
+ * bool over
  * Info_Strip strip
  * std::vector<std::unique_ptr<Actor>> actors 
  * std::vector<std::unique_ptr<Projectile>> projectiles
  * float projectile_delay
- * float frame_delay
- * int frame_counter
- * int FPS
- * sf::Text FPS_text
+ * Replay * recording, gets the state hashes, if any
  */
 
 class Field : public Game_State
 {
+    friend class Benchmark;
 public:
-    Field(Game &);
+    Field(Game &, unsigned = std::random_device{}(), Difficulty const & = Difficulty{});
     ~Field() = default;
+    Field(Field const &) = delete;
+    Field & operator=(Field const &) = delete;
     void draw(sf::RenderWindow &) override;
     void update(sf::Time &) override;
     void handle_input(sf::Event &) override; 
+    static sf::Time const tick;
+    bool is_over() const;
+    unsigned get_seed() const;
+    Difficulty get_difficulty() const;
+    int get_score() const;
+    int get_wave() const;
+    float get_time() const;
+    int get_lives() const;
+    void set_input(std::unique_ptr<Input_Source>);
+    unsigned get_keys() const override;
+    std::vector<std::unique_ptr<Actor>> const & get_actors() const;
+    std::vector<std::unique_ptr<Projectile>> const & get_projectiles() const;
+    std::string save_state() const;
+    void load_state(std::string const &);
+    uint32_t state_hash() const;
+    void record_hashes(Replay &);
 private:
+    void write_state(State_Writer &) const;
     void make_blocks();
     void make_enemies();
     void make_enemies_shoot();
     void collision_control();
+    void end_game();
+    void projectile_update(sf::Time &);
     void actor_update(sf::Time &); 
     
+    unsigned seed{};
+    Difficulty difficulty{};
+    Random_Engine random_engine{};
+    int wave{};
+    float game_time{};
+    bool over{false};
     Info_Strip strip{};
     std::vector<std::unique_ptr<Actor>> actors{}; 
     std::vector<std::unique_ptr<Projectile>> projectiles{};
     float projectile_delay{};
-    float frame_delay{};
-    int frame_counter{};
-    int FPS{};
-    sf::Text FPS_text{};
     sf::Text energy_text{};
+    Replay * recording{nullptr};
 };
 
 
@@ -207,6 +254,8 @@ public:
  *
  * DATA MEMBERS
  * sf::Text lose_text
+ * sf::Text beaten_text, the share of the games the score beat
+ * int beaten_percent, shown in beaten_text, laid out when it changes
  *
  */
 class Lose : public Game_State
@@ -218,6 +267,8 @@ public:
     void handle_input(sf::Event &) override;
 private:
     sf::Text lose_text{};
+    sf::Text beaten_text{};
+    int beaten_percent{-1};
 };
 
 #endif
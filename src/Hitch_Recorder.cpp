@@ -0,0 +1,165 @@
+/*
+ * IDENTIFICATION
+ * File name:  Hitch_Recorder.cpp
+ * Type:       Definitions for module Hitch_Recorder
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Hitch_Recorder class which keeps the last
+ * frames and saves them to a file when a frame takes too long.
+ */
+
+#include "Hitch_Recorder.hpp"
+#include "Controllers.hpp"
+#include <ctime>
+#include <fstream>
+
+#define dump_interval std::chrono::seconds(1)
+
+using namespace std;
+
+/*
+ * FUNCTION Hitch_Recorder(float)
+ *
+ * Constructor for Hitch_Recorder. The writer thread is started at
+ * the first hitch, headless games never need one.
+ */
+
+Hitch_Recorder::Hitch_Recorder(float budget_init) :
+    budget{budget_init}
+{}
+
+/*
+ * FUNCTION ~Hitch_Recorder()
+ *
+ * Destructor for Hitch_Recorder, waits for a file being written.
+ */
+
+Hitch_Recorder::~Hitch_Recorder()
+{
+    {
+	lock_guard<mutex> lock{dump_mutex};
+	stopping = true;
+    }
+    dump_ready.notify_one();
+
+    if (writer.joinable())
+	writer.join();
+}
+
+/*
+ * FUNCTION record(Frame const &)
+ *
+ * Adds a frame to the buffer. If it took longer than the budget the
+ * buffer is copied, oldest frame first, for the writer thread.
+ */
+
+void Hitch_Recorder::record(Frame const & frame)
+{
+    frames[next] = frame;
+    next = (next + 1) % capacity;
+    if (count < capacity)
+	++count;
+
+    if (budget <= 0 || frame.frame_time <= budget)
+	return;
+
+    chrono::steady_clock::time_point now{chrono::steady_clock::now()};
+    if (now - last_dump < dump_interval)
+	return;
+
+    unique_lock<mutex> lock{dump_mutex, try_to_lock};
+    if (!lock.owns_lock() || pending)
+	return;
+
+    pending = make_unique<vector<Frame>>();
+    for (size_t index{}; index < count; ++index)
+	pending -> push_back(frames[(next + capacity - count + index) % capacity]);
+
+    last_dump = now;
+    lock.unlock();
+
+    if (!writer.joinable())
+	writer = thread{&Hitch_Recorder::run, this};
+    dump_ready.notify_one();
+}
+
+/*
+ * FUNCTION set_budget(float)
+ *
+ * Sets the frame time in milliseconds that counts as a hitch.
+ */
+
+void Hitch_Recorder::set_budget(float new_budget)
+{
+    budget = new_budget;
+}
+
+/*
+ * FUNCTION run()
+ *
+ * The writer thread, writes the pending frames when there are some.
+ */
+
+void Hitch_Recorder::run()
+{
+    while (true)
+    {
+	unique_ptr<vector<Frame>> taken{};
+
+	{
+	    unique_lock<mutex> lock{dump_mutex};
+	    dump_ready.wait(lock, [this]() { return stopping || pending; });
+
+	    if (!pending)
+		return;
+	    taken.swap(pending);
+	}
+
+	write(*taken);
+    }
+}
+
+/*
+ * FUNCTION write(vector<Frame> const &)
+ *
+ * Writes the frames as CSV to a file named after the time and the
+ * number of the last frame, the one that took too long.
+ */
+
+void Hitch_Recorder::write(vector<Frame> const & taken)
+{
+    time_t now{time(nullptr)};
+    tm local{};
+    localtime_r(&now, &local);
+
+    char date[32];
+    strftime(date, sizeof(date), "%Y%m%d-%H%M%S", &local);
+
+    ofstream out{string{"hitch-"} + date + "-f" + to_string(taken.back().number) + ".csv"};
+
+    out << "frame,frame_ms";
+    for (size_t phase{}; phase < Profiler::PHASE_COUNT; ++phase)
+	out << "," << Profiler::phase_name(Profiler::Phase(phase)) << "_ms";
+    out << ",left,right,space,shift";
+    for (size_t counter{}; counter < Counters::COUNTER_COUNT; ++counter)
+	out << "," << Counters::name(Counters::Counter(counter));
+    out << "\n";
+
+    for (Frame const & frame : taken)
+    {
+	out << frame.number << "," << frame.frame_time;
+	for (float phase_time : frame.phase_times)
+	    out << "," << phase_time;
+	out << "," << bool(frame.keys & Controllers::LEFT)
+	    << "," << bool(frame.keys & Controllers::RIGHT)
+	    << "," << bool(frame.keys & Controllers::SPACE)
+	    << "," << bool(frame.keys & Controllers::SHIFT);
+	for (uint64_t value : frame.counters)
+	    out << "," << value;
+	out << "\n";
+    }
+}
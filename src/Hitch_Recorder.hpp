@@ -0,0 +1,100 @@
+/*
+ * IDENTIFICATION
+ * File name:  Hitch_Recorder.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Hitch_Recorder class which keeps the last
+ * frames and saves them to a file when a frame takes too long.
+ */
+
+#ifndef HITCH_RECORDER_H
+#define HITCH_RECORDER_H
+
+#include "Profiler.hpp"
+#include "Counters.hpp"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* CLASS Hitch_Recorder
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * A flight recorder for frames. Every frame the phase times, the
+ * counters and the held keys are copied into a ring buffer of the
+ * last frames, which costs a few hundred bytes of copying and no
+ * allocation. When a frame takes longer than the budget the buffer
+ * is handed to a thread of its own, started at the first hitch,
+ * that writes it to hitch-DATE-TIME-fFRAME.csv so that the game does
+ * not wait for the disk. At most one file is written per second.
+ *
+ * CONSTRUCTORS
+ * Hitch_Recorder(float), the budget in milliseconds, 0 turns
+ * recording off
+ *
+ * OPERATIONS
+ * record, input Frame const &, output none
+ * set_budget, input float, output none
+ *
+ * DATA MEMBERS
+ * float budget
+ * array<Frame, capacity> frames, the ring buffer
+ * size_t next, index of the next frame in frames
+ * size_t count, frames in the buffer
+ * time_point last_dump
+ * mutex dump_mutex
+ * condition_variable dump_ready
+ * unique_ptr<vector<Frame>> pending, frames waiting to be written
+ * bool stopping
+ * thread writer
+ */
+
+class Hitch_Recorder
+{
+public:
+    struct Frame
+    {
+	uint64_t number;
+	float frame_time;
+	std::array<float, Profiler::PHASE_COUNT> phase_times;
+	unsigned keys;
+	Counters::Values counters;
+    };
+
+    explicit Hitch_Recorder(float = 20);
+    ~Hitch_Recorder();
+    Hitch_Recorder(Hitch_Recorder const &) = delete;
+    Hitch_Recorder & operator=(Hitch_Recorder const &) = delete;
+    void record(Frame const &);
+    void set_budget(float);
+private:
+    static std::size_t const capacity{300};
+
+    void run();
+    void write(std::vector<Frame> const &);
+
+    float budget{};
+    std::array<Frame, capacity> frames{};
+    std::size_t next{};
+    std::size_t count{};
+    std::chrono::steady_clock::time_point last_dump{};
+    std::mutex dump_mutex{};
+    std::condition_variable dump_ready{};
+    std::unique_ptr<std::vector<Frame>> pending{};
+    bool stopping{false};
+    std::thread writer{};
+};
+
+#endif
@@ -11,6 +11,8 @@
  * Definitions for the class Info_Strip
  */
 #include "Info_Strip.hpp"
+#include "Assets.hpp"
+#include "Counters.hpp"
 
 using namespace std;
 /*
@@ -20,19 +22,13 @@ using namespace std;
  */
 Info_Strip::Info_Strip()
 {
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
-
-    lives_text = sf::Text("LIVES: ", font, 23);
+    lives_text = Assets::text("LIVES: ", 23, Assets::INFO_STRIP);
     lives_text.setPosition(100, 10);
 
-    score_text = sf::Text("", font, 23);
+    score_text = Assets::text("", 23, Assets::INFO_STRIP);
     score_text.setPosition(820, 10); 
 
-    if(!texture.loadFromFile("sprites/heart.png"))
-	throw invalid_argument("Heart not found!");
-    
-    sprite.setTexture(texture);
+    Assets::apply_texture(sprite, "sprites/heart.png", Assets::INFO_STRIP);
 }
 /*
  * FUNCTION draw(RenderWindow &) 
@@ -52,14 +48,20 @@ void Info_Strip::draw(sf::RenderWindow & window)
     
     window.draw(score_text); 
     window.draw(lives_text);
+    Counters::add(Counters::DRAW_CALLS, lives + 2);
 }
 /*
  * FUNCTION update() 
  *
- * updates the info_strip
+ * updates the info_strip, the text is only made again
+ * when the score has changed
  */
 void Info_Strip::update()
 {
+    if (score == shown_score)
+	return;
+
+    shown_score = score;
     score_text.setString("SCORE: " + to_string(score));
 }
 /*
@@ -86,3 +88,42 @@ int Info_Strip::update_lives(int life)
     
     return lives;
 }
+/*
+ * FUNCTION get_score() 
+ *
+ * returns the score datamember
+ */
+int Info_Strip::get_score() const
+{
+    return score;
+}
+/*
+ * FUNCTION get_lives() 
+ *
+ * returns the lives datamember
+ */
+int Info_Strip::get_lives() const
+{
+    return lives;
+}
+/*
+ * FUNCTION save_state(State_Writer &) 
+ *
+ * writes the score and the lives
+ */
+void Info_Strip::save_state(State_Writer & writer) const
+{
+    writer.write_int(score);
+    writer.write_int(lives);
+}
+/*
+ * FUNCTION load_state(State_Reader &) 
+ *
+ * reads the score and the lives
+ */
+void Info_Strip::load_state(State_Reader & reader)
+{
+    score = reader.read_int();
+    lives = reader.read_int();
+    update();
+}
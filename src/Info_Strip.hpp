@@ -15,6 +15,7 @@
 #define INFO_STRIP_H
 
 #include <SFML/Graphics.hpp>
+#include "State_Stream.hpp"
 /* CLASS Info_Strip
  * 
  *
@@ -33,15 +34,18 @@
  * update, input none, output none
  * update_score, input int, output int
  * update_lives, input int, output int
+ * get_score, input none, output int
+ * get_lives, input none, output int
+ * save_state, input State_Writer &, output none
+ * load_state, input State_Reader &, output none
  *
  * DATA MEMBERS
  * int lives
  * int scores
+ * int shown_score, the score in score_text
  * Text lives_text
  * Text score_text
- * Font font
  * Sprite sprite
- * Texture texture
  * Vector2f position
  *
  */
@@ -54,14 +58,17 @@ public:
     void update();
     int update_score(int);
     int update_lives(int);
+    int get_score() const;
+    int get_lives() const;
+    void save_state(State_Writer &) const;
+    void load_state(State_Reader &);
 private:
     int lives{3};
     int score{};
+    int shown_score{-1};
     sf::Text lives_text{}; 
     sf::Text score_text{};
-    sf::Font font{};
     sf::Sprite sprite{};
-    sf::Texture texture{};
     sf::Vector2f position{};
 };
 
@@ -0,0 +1,126 @@
+/*
+ * IDENTIFICATION
+ * File name:  Input_Source.cpp
+ * Type:       Definitions for module Input_Source
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Input_Source classes Keyboard_Input,
+ * Replay_Input and Remote_Input.
+ */
+
+#include "Input_Source.hpp"
+
+using namespace std;
+
+/*
+ * --------------------------------------------------
+ * ------------------ KEYBOARD_INPUT ----------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION handle_input(sf::Event &)
+ *
+ * Tells the controllers if a key is pressed or released.
+ */
+
+void Keyboard_Input::handle_input(sf::Event & event)
+{
+    switch (event.type)
+    {
+        case sf::Event::KeyPressed:
+            controllers.handle_input(true, event.key.code);
+            break;
+        case sf::Event::KeyReleased:
+            controllers.handle_input(false, event.key.code);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * FUNCTION next_keys(sf::Time const &)
+ *
+ * Returns the keys held right now.
+ */
+
+unsigned Keyboard_Input::next_keys(sf::Time const &)
+{
+    return controllers.get_keys();
+}
+
+/*
+ * --------------------------------------------------
+ * ------------------ REPLAY_INPUT ------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Replay_Input(vector<uint8_t>, size_t)
+ *
+ * Constructor for Replay_Input, takes the keys of every frame
+ * and the frame to start playing from.
+ */
+
+Replay_Input::Replay_Input(vector<uint8_t> recording_init, size_t frame_init) :
+    recording{move(recording_init)}, frame{frame_init}
+{
+}
+
+/*
+ * FUNCTION next_keys(sf::Time const &)
+ *
+ * Returns the keys of the next frame in the recording.
+ */
+
+unsigned Replay_Input::next_keys(sf::Time const &)
+{
+    if (finished())
+	return 0;
+
+    return recording[frame++];
+}
+
+/*
+ * FUNCTION finished()
+ *
+ * Returns true when every frame has been played.
+ */
+
+bool Replay_Input::finished() const
+{
+    return frame >= recording.size();
+}
+
+/*
+ * --------------------------------------------------
+ * ------------------ REMOTE_INPUT ------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION next_keys(sf::Time const &)
+ *
+ * Returns the keys last set.
+ */
+
+unsigned Remote_Input::next_keys(sf::Time const &)
+{
+    return keys;
+}
+
+/*
+ * FUNCTION set_keys(unsigned)
+ *
+ * Sets the keys held from now on.
+ */
+
+void Remote_Input::set_keys(unsigned new_keys)
+{
+    keys = new_keys;
+}
@@ -0,0 +1,144 @@
+/*
+ * IDENTIFICATION
+ * File name:  Input_Source.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations of base class Input_Source and its sub classes
+ * Keyboard_Input, Replay_Input and Remote_Input which decide
+ * what keys the player holds.
+ */
+
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include <SFML/Graphics.hpp>
+#include "Controllers.hpp"
+#include <vector>
+#include <cstdint>
+
+/* CLASS Input_Source
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Something that can play the game. The player asks it once every
+ * frame which keys are held, as a bitmask of Controllers::Keys.
+ *
+ * CONSTRUCTORS
+ * Input_Source(), default constructor.
+ *
+ * OPERATIONS
+ * virtual handle_input, input Event &, output none
+ * virtual next_keys, input Time const &, output unsigned
+ */
+
+class Input_Source
+{
+public:
+    Input_Source() = default;
+    virtual ~Input_Source() = default;
+    virtual void handle_input(sf::Event &) {}
+    virtual unsigned next_keys(sf::Time const &) = 0;
+};
+
+/* CLASS Keyboard_Input
+ *
+ * PARENT CLASS
+ * Input_Source
+ *
+ * DESCRIPTION
+ * The keys pressed by a human at the keyboard.
+ *
+ * CONSTRUCTORS
+ * Keyboard_Input(), default constructor.
+ *
+ * OPERATIONS
+ * handle_input, input Event &, output none
+ * next_keys, input Time const &, output unsigned
+ *
+ * DATA MEMBERS
+ * Controllers controllers
+ */
+
+class Keyboard_Input : public Input_Source
+{
+public:
+    Keyboard_Input() = default;
+    ~Keyboard_Input() = default;
+    void handle_input(sf::Event &) override;
+    unsigned next_keys(sf::Time const &) override;
+private:
+    Controllers controllers{};
+};
+
+/* CLASS Replay_Input
+ *
+ * PARENT CLASS
+ * Input_Source
+ *
+ * DESCRIPTION
+ * Plays back recorded keys, one bitmask per frame. No keys are
+ * held after the end of the recording.
+ *
+ * CONSTRUCTORS
+ * Replay_Input(vector<uint8_t>, size_t), the keys and the first frame
+ *
+ * OPERATIONS
+ * next_keys, input Time const &, output unsigned
+ * finished, input none, output bool
+ *
+ * DATA MEMBERS
+ * vector<uint8_t> recording
+ * size_t frame
+ */
+
+class Replay_Input : public Input_Source
+{
+public:
+    Replay_Input(std::vector<uint8_t>, std::size_t = 0);
+    ~Replay_Input() = default;
+    unsigned next_keys(sf::Time const &) override;
+    bool finished() const;
+private:
+    std::vector<uint8_t> recording{};
+    std::size_t frame{};
+};
+
+/* CLASS Remote_Input
+ *
+ * PARENT CLASS
+ * Input_Source
+ *
+ * DESCRIPTION
+ * Keys set from outside the game before each frame, used by the
+ * bot training environment.
+ *
+ * CONSTRUCTORS
+ * Remote_Input(), default constructor.
+ *
+ * OPERATIONS
+ * next_keys, input Time const &, output unsigned
+ * set_keys, input unsigned, output none
+ *
+ * DATA MEMBERS
+ * unsigned keys
+ */
+
+class Remote_Input : public Input_Source
+{
+public:
+    Remote_Input() = default;
+    ~Remote_Input() = default;
+    unsigned next_keys(sf::Time const &) override;
+    void set_keys(unsigned);
+private:
+    unsigned keys{};
+};
+
+#endif
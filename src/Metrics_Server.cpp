@@ -0,0 +1,291 @@
+/*
+ * IDENTIFICATION
+ * File name:  Metrics_Server.cpp
+ * Type:       Definitions for module Metrics_Server
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Metrics_Server class which serves the state
+ * of the game in the Prometheus text format.
+ */
+
+#include "Metrics_Server.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#define request_limit 4096
+#define fps_smoothing 0.05f
+
+using namespace std;
+
+// Upper bounds of the frame time buckets in seconds
+array<float, Metrics_Server::bucket_count> const Metrics_Server::buckets
+{0.005f, 0.010f, 0.0167f, 0.020f, 0.025f, 0.0333f, 0.050f, 0.100f};
+
+// Shares of the games for the score quantiles
+array<double, 3> const Metrics_Server::score_quantiles{0.5, 0.9, 0.99};
+
+/*
+ * --------------------------------------------------
+ * --------------------- SNAPSHOT -------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION add_frame_time(float)
+ *
+ * Counts a frame of the given milliseconds in the histogram and
+ * the frame rate.
+ */
+
+void Metrics_Server::Snapshot::add_frame_time(float milliseconds)
+{
+    float seconds{milliseconds / 1000};
+    size_t bucket{};
+
+    while (bucket < bucket_count && seconds > buckets[bucket])
+	++bucket;
+
+    ++frame_counts[bucket];
+    frame_seconds += seconds;
+    ++frames;
+
+    if (milliseconds > 0)
+	fps = fps == 0 ? 1000 / milliseconds :
+	    fps + fps_smoothing * (1000 / milliseconds - fps);
+}
+
+/*
+ * --------------------------------------------------
+ * --------------------- METRICS SERVER -------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Metrics_Server(unsigned short)
+ *
+ * Constructor for Metrics_Server. Listens on localhost only and
+ * starts the server thread.
+ */
+
+Metrics_Server::Metrics_Server(unsigned short port)
+{
+    if (listener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done)
+	throw invalid_argument("Could not serve metrics on port " +
+			       to_string(port) + "!");
+
+    server = thread{&Metrics_Server::run, this};
+}
+
+/*
+ * FUNCTION ~Metrics_Server()
+ *
+ * Destructor for Metrics_Server, stops the server thread.
+ */
+
+Metrics_Server::~Metrics_Server()
+{
+    stopping = true;
+    server.join();
+}
+
+/*
+ * FUNCTION next()
+ *
+ * Returns the snapshot the game thread fills in. It keeps its
+ * values between frames, so counters are simply added to.
+ */
+
+Metrics_Server::Snapshot & Metrics_Server::next()
+{
+    return current;
+}
+
+/*
+ * FUNCTION publish()
+ *
+ * Makes the filled in snapshot the one the server answers with.
+ */
+
+void Metrics_Server::publish()
+{
+    slots[write_slot] = current;
+    write_slot = middle_slot.exchange(write_slot | fresh,
+				      memory_order_acq_rel) & ~fresh;
+}
+
+/*
+ * FUNCTION get_port()
+ *
+ * Returns the port the server listens on.
+ */
+
+unsigned short Metrics_Server::get_port() const
+{
+    return listener.getLocalPort();
+}
+
+/*
+ * FUNCTION run()
+ *
+ * The server thread. Waits for connections a short while at a time
+ * so that it notices when it should stop.
+ */
+
+void Metrics_Server::run()
+{
+    sf::SocketSelector selector{};
+    selector.add(listener);
+
+    while (!stopping)
+    {
+	if (!selector.wait(sf::milliseconds(200)))
+	    continue;
+
+	sf::TcpSocket client{};
+	if (listener.accept(client) == sf::Socket::Done)
+	    answer(client);
+    }
+}
+
+/*
+ * FUNCTION answer(sf::TcpSocket &)
+ *
+ * Reads an HTTP request and answers it. A client gets one second
+ * to send its request.
+ */
+
+void Metrics_Server::answer(sf::TcpSocket & client)
+{
+    sf::SocketSelector selector{};
+    selector.add(client);
+
+    string request{};
+    char buffer[512];
+
+    while (request.find("\r\n\r\n") == string::npos && request.size() < request_limit)
+    {
+	size_t received{};
+	if (!selector.wait(sf::seconds(1)) ||
+	    client.receive(buffer, sizeof(buffer), received) != sf::Socket::Done)
+	    return;
+	request.append(buffer, received);
+    }
+
+    string status{"200 OK"};
+    string body{};
+
+    if (request.compare(0, 13, "GET /metrics ") == 0)
+	body = render();
+    else
+    {
+	status = "404 Not Found";
+	body = "Only /metrics is served\n";
+    }
+
+    string response{"HTTP/1.1 " + status + "\r\n"
+		    "Content-Type: text/plain; version=0.0.4\r\n"
+		    "Content-Length: " + to_string(body.size()) + "\r\n"
+		    "Connection: close\r\n\r\n" + body};
+
+    client.send(response.data(), response.size());
+}
+
+/*
+ * FUNCTION render()
+ *
+ * Takes the latest published snapshot and writes it in the
+ * Prometheus text format. The resident memory is read here, on
+ * the server thread.
+ */
+
+string Metrics_Server::render()
+{
+    if (middle_slot.load(memory_order_relaxed) & fresh)
+	read_slot = middle_slot.exchange(read_slot, memory_order_acq_rel) & ~fresh;
+
+    Snapshot const & snapshot = slots[read_slot];
+    ostringstream out{};
+
+    out << "# HELP psi_frame_seconds Time of a whole frame.\n"
+	<< "# TYPE psi_frame_seconds histogram\n";
+    uint64_t cumulative{};
+    for (size_t bucket{}; bucket < bucket_count; ++bucket)
+    {
+	cumulative += snapshot.frame_counts[bucket];
+	out << "psi_frame_seconds_bucket{le=\"" << buckets[bucket] << "\"} "
+	    << cumulative << "\n";
+    }
+    out << "psi_frame_seconds_bucket{le=\"+Inf\"} " << snapshot.frames << "\n"
+	<< "psi_frame_seconds_sum " << snapshot.frame_seconds << "\n"
+	<< "psi_frame_seconds_count " << snapshot.frames << "\n";
+
+    auto metric = [&out](char const * name, char const * type,
+			 char const * help, auto value)
+	{
+	    out << "# HELP " << name << " " << help << "\n"
+		<< "# TYPE " << name << " " << type << "\n"
+		<< name << " " << value << "\n";
+	};
+
+    metric("psi_fps", "gauge", "Frames per second, smoothed.", snapshot.fps);
+    metric("psi_actors", "gauge", "Actors alive.", snapshot.actors);
+    metric("psi_projectiles", "gauge", "Projectiles alive.", snapshot.projectiles);
+    metric("psi_allocations_total", "counter", "Memory allocations in the game loop.",
+	   snapshot.allocations);
+    metric("psi_allocated_bytes_total", "counter", "Bytes allocated in the game loop.",
+	   snapshot.allocated_bytes);
+    metric("psi_texture_loads_total", "counter", "Textures loaded from file.",
+	   snapshot.texture_loads);
+    metric("psi_sound_plays_total", "counter", "Sounds played.", snapshot.sound_plays);
+    metric("psi_cached_textures", "gauge", "Textures in the asset cache.",
+	   snapshot.assets.textures);
+    metric("psi_cached_image_sizes", "gauge", "Image sizes in the headless asset cache.",
+	   snapshot.assets.sizes);
+    metric("psi_cached_sound_buffers", "gauge", "Sound buffers in the asset cache.",
+	   snapshot.assets.sound_buffers);
+    metric("psi_playing", "gauge", "1 while a game is played, 0 in the menus.",
+	   int(snapshot.playing));
+    metric("psi_score", "gauge", "Score of the current game.", snapshot.score);
+    metric("psi_wave", "gauge", "Wave of enemies in the current game.", snapshot.wave);
+    metric("psi_lives", "gauge", "Lives left in the current game.", snapshot.lives);
+
+    out << "# HELP psi_game_scores Scores of all games on record.\n"
+	<< "# TYPE psi_game_scores histogram\n";
+    cumulative = 0;
+    for (size_t bin{}; bin + 1 < Score_Sketch::bin_count; ++bin)
+    {
+	cumulative += snapshot.score_bins[bin];
+	out << "psi_game_scores_bucket{le=\"" << (bin + 1) * Score_Sketch::bin_width
+	    << "\"} " << cumulative << "\n";
+    }
+    out << "psi_game_scores_bucket{le=\"+Inf\"} " << snapshot.games << "\n"
+	<< "psi_game_scores_sum " << snapshot.score_sum << "\n"
+	<< "psi_game_scores_count " << snapshot.games << "\n";
+
+    out << "# HELP psi_game_score Quantiles of the scores of all games on record.\n"
+	<< "# TYPE psi_game_score summary\n";
+    for (size_t quantile{}; quantile < snapshot.score_quantiles.size(); ++quantile)
+	out << "psi_game_score{quantile=\"" << score_quantiles[quantile] << "\"} "
+	    << snapshot.score_quantiles[quantile] << "\n";
+    out << "psi_game_score_sum " << snapshot.score_sum << "\n"
+	<< "psi_game_score_count " << snapshot.games << "\n";
+
+#ifdef __linux__
+    ifstream statm{"/proc/self/statm"};
+    uint64_t size{}, resident{};
+    if (statm >> size >> resident)
+	metric("psi_resident_memory_bytes", "gauge", "Resident memory of the game.",
+	       resident * sysconf(_SC_PAGESIZE));
+#endif
+
+    return out.str();
+}
@@ -0,0 +1,116 @@
+/*
+ * IDENTIFICATION
+ * File name:  Metrics_Server.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Metrics_Server class which serves the state
+ * of the game in the Prometheus text format.
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <SFML/Network.hpp>
+#include "Assets.hpp"
+#include "Score_Sketch.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/* CLASS Metrics_Server
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Answers GET /metrics on a port of localhost from a thread of its
+ * own. The game thread fills in next() and calls publish() once per
+ * frame. The snapshots are passed through a triple buffer: the game
+ * thread and the server thread each own one slot and swap it with
+ * the third through an atomic index, so neither ever waits for the
+ * other and the server never sees a half written snapshot.
+ *
+ * CONSTRUCTORS
+ * Metrics_Server(unsigned short), the port, 0 picks a free one
+ *
+ * OPERATIONS
+ * next, input none, output Snapshot &, the snapshot to fill in
+ * publish, input none, output none
+ * get_port, input none, output unsigned short
+ *
+ * DATA MEMBERS
+ * Snapshot current, owned by the game thread
+ * array<Snapshot, 3> slots
+ * unsigned write_slot, owned by the game thread
+ * unsigned read_slot, owned by the server thread
+ * atomic<unsigned> middle_slot, the slot between them, with the
+ *     fresh flag set when the game thread has published into it
+ * TcpListener listener
+ * atomic<bool> stopping
+ * thread server
+ */
+
+class Metrics_Server
+{
+public:
+    static std::size_t const bucket_count{8};
+    static std::array<float, bucket_count> const buckets;
+    static std::array<double, 3> const score_quantiles;
+
+    struct Snapshot
+    {
+	void add_frame_time(float);
+
+	std::array<uint64_t, bucket_count + 1> frame_counts;
+	double frame_seconds;
+	uint64_t frames;
+	float fps;
+	uint64_t actors;
+	uint64_t projectiles;
+	uint64_t allocations;
+	uint64_t allocated_bytes;
+	uint64_t texture_loads;
+	uint64_t sound_plays;
+	Assets::Stats assets;
+	bool playing;
+	int score;
+	int wave;
+	int lives;
+	Score_Sketch::Bins score_bins;
+	double score_sum;
+	uint64_t games;
+	std::array<int, 3> score_quantiles;
+    };
+
+    explicit Metrics_Server(unsigned short);
+    ~Metrics_Server();
+    Metrics_Server(Metrics_Server const &) = delete;
+    Metrics_Server & operator=(Metrics_Server const &) = delete;
+    Snapshot & next();
+    void publish();
+    unsigned short get_port() const;
+private:
+    static unsigned const fresh{4};
+
+    void run();
+    void answer(sf::TcpSocket &);
+    std::string render();
+
+    Snapshot current{};
+    std::array<Snapshot, 3> slots{};
+    unsigned write_slot{0};
+    unsigned read_slot{1};
+    std::atomic<unsigned> middle_slot{2};
+    sf::TcpListener listener{};
+    std::atomic<bool> stopping{false};
+    std::thread server{};
+};
+
+#endif
@@ -0,0 +1,281 @@
+/*
+ * IDENTIFICATION
+ * File name:  Profiler.cpp
+ * Type:       Definitions for module Profiler
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Profiler class which measures how long each
+ * phase of a frame takes and shows it in an overlay.
+ */
+
+#include "Profiler.hpp"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+
+#define text_interval 15
+#define graph_width 240
+#define graph_height 60
+#define graph_max_ms 33.3f
+
+using namespace std;
+
+/*
+ * --------------------------------------------------
+ * --------------------- SCOPE ----------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Scope(Profiler &, Phase)
+ *
+ * Constructor for Scope, starts measuring the phase.
+ */
+
+Profiler::Scope::Scope(Profiler & profiler_init, Phase phase_init) :
+    profiler{profiler_init}, phase{phase_init}, start{Clock::now()},
+    allocations{Allocations::get().count}
+{}
+
+/*
+ * FUNCTION ~Scope()
+ *
+ * Destructor for Scope, adds the time since construction to the phase.
+ */
+
+Profiler::Scope::~Scope()
+{
+    profiler.add(phase, Clock::now() - start,
+		 Allocations::get().count - allocations);
+}
+
+/*
+ * --------------------------------------------------
+ * --------------------- PROFILER -------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Profiler()
+ *
+ * Constructor for Profiler. The font is taken from the assets the
+ * first time the overlay is drawn, so that headless games never
+ * need it.
+ */
+
+Profiler::Profiler()
+{
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+}
+
+/*
+ * FUNCTION end_frame()
+ *
+ * Saves the times of the frame that ended now and starts a new one.
+ */
+
+void Profiler::end_frame()
+{
+    Clock::time_point now{Clock::now()};
+
+    for (size_t phase{}; phase < PHASE_COUNT; ++phase)
+    {
+	samples[phase][frame] =
+	    chrono::duration<float, milli>(current[phase]).count();
+	current[phase] = Clock::duration::zero();
+	allocation_samples[phase][frame] = current_allocations[phase];
+	current_allocations[phase] = 0;
+    }
+    samples[PHASE_COUNT][frame] =
+	chrono::duration<float, milli>(now - frame_start).count();
+
+    frame_start = now;
+    frame = (frame + 1) % history;
+    frame_count = min(frame_count + 1, history);
+
+    if (visible && frame % text_interval == 0)
+	update_text();
+}
+
+/*
+ * FUNCTION add(Phase, Clock::duration, uint64_t)
+ *
+ * Adds time and allocations to a phase of the current frame.
+ */
+
+void Profiler::add(Phase phase, Clock::duration time, uint64_t allocations)
+{
+    current[phase] += time;
+    current_allocations[phase] += allocations;
+}
+
+/*
+ * FUNCTION toggle()
+ *
+ * Shows or hides the overlay.
+ */
+
+void Profiler::toggle()
+{
+    visible = !visible;
+
+    if (visible)
+	update_text();
+}
+
+/*
+ * FUNCTION is_visible()
+ *
+ * Returns true if the overlay is shown.
+ */
+
+bool Profiler::is_visible() const
+{
+    return visible;
+}
+
+/*
+ * FUNCTION draw(sf::RenderWindow &)
+ *
+ * Draws the table of phase times and the frame time graph. The graph
+ * has a line at 1/60 second, the time one frame may take.
+ */
+
+void Profiler::draw(sf::RenderWindow & window)
+{
+    if (!visible)
+	return;
+
+    sf::Vector2f position{10, 60};
+    sf::FloatRect bounds{text.getGlobalBounds()};
+
+    background.setPosition(position);
+    background.setSize(sf::Vector2f(max<float>(bounds.width, graph_width) + 20,
+				    bounds.height + graph_height + 40));
+    window.draw(background);
+
+    text.setPosition(position.x + 10, position.y + 10);
+    window.draw(text);
+
+    float bottom{position.y + bounds.height + graph_height + 30};
+    float scale{graph_height / graph_max_ms};
+
+    sf::VertexArray budget{sf::Lines, 2};
+    budget[0] = sf::Vertex(sf::Vector2f(position.x + 10, bottom - 16.7f * scale),
+			   sf::Color::Red);
+    budget[1] = sf::Vertex(sf::Vector2f(position.x + 10 + graph_width,
+					bottom - 16.7f * scale), sf::Color::Red);
+    window.draw(budget);
+
+    sf::VertexArray graph{sf::LineStrip, frame_count};
+    for (size_t index{}; index < frame_count; ++index)
+    {
+	size_t sample = (frame + history - frame_count + index) % history;
+	float height = min(samples[PHASE_COUNT][sample], graph_max_ms) * scale;
+
+	graph[index] = sf::Vertex(sf::Vector2f(position.x + 10 + index * graph_width / history,
+					       bottom - height), sf::Color::Green);
+    }
+    window.draw(graph);
+}
+
+/*
+ * FUNCTION get_frame_time()
+ *
+ * Returns the time of the last whole frame in milliseconds.
+ */
+
+float Profiler::get_frame_time() const
+{
+    return samples[PHASE_COUNT][(frame + history - 1) % history];
+}
+
+/*
+ * FUNCTION get_phase_time(Phase)
+ *
+ * Returns the time of a phase in the last frame in milliseconds.
+ */
+
+float Profiler::get_phase_time(Phase phase) const
+{
+    return samples[phase][(frame + history - 1) % history];
+}
+
+/*
+ * FUNCTION phase_name(Phase)
+ *
+ * Returns the name of a phase.
+ */
+
+string Profiler::phase_name(Phase phase)
+{
+    switch (phase)
+    {
+    case EVENTS:      return "events";
+    case PROJECTILES: return "projectiles";
+    case ACTORS:      return "actors";
+    case SHOOTING:    return "shooting";
+    case COLLISION:   return "collision";
+    case DRAW:        return "draw";
+    case DISPLAY:     return "display";
+    default:          return "frame";
+    }
+}
+
+/*
+ * FUNCTION update_text()
+ *
+ * Computes the average, median and 99th percentile of every phase
+ * and its allocations per frame over the saved frames, and writes
+ * them to the overlay text.
+ */
+
+void Profiler::update_text()
+{
+    ostringstream out{};
+    out << fixed << setprecision(2)
+	<< left << setw(12) << "ms" << right
+	<< setw(7) << "avg" << setw(7) << "p50" << setw(7) << "p99"
+	<< setw(7) << "alloc" << "\n";
+
+    for (size_t phase{}; phase <= PHASE_COUNT; ++phase)
+    {
+	vector<float> times(samples[phase].begin(),
+			    samples[phase].begin() + frame_count);
+	float average{}, median{}, high{};
+
+	if (!times.empty())
+	{
+	    average = accumulate(times.begin(), times.end(), 0.0f) / times.size();
+
+	    nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+	    median = times[times.size() / 2];
+
+	    size_t percentile = times.size() * 99 / 100;
+	    nth_element(times.begin(), times.begin() + percentile, times.end());
+	    high = times[percentile];
+	}
+
+	out << left << setw(12) << phase_name(Phase(phase)) << right
+	    << setw(7) << average << setw(7) << median << setw(7) << high;
+
+	if (phase < PHASE_COUNT && frame_count > 0)
+	    out << setw(7) << accumulate(allocation_samples[phase].begin(),
+					 allocation_samples[phase].begin() + frame_count,
+					 0.0f) / frame_count;
+	out << "\n";
+    }
+
+    float total{accumulate(samples[PHASE_COUNT].begin(),
+			   samples[PHASE_COUNT].begin() + frame_count, 0.0f)};
+    if (total > 0)
+	out << "FPS: " << setprecision(0) << frame_count * 1000 / total;
+
+    text = Assets::text(out.str(), 14, Assets::PROFILER);
+}
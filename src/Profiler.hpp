@@ -0,0 +1,117 @@
+/*
+ * IDENTIFICATION
+ * File name:  Profiler.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Profiler class which measures how long each
+ * phase of a frame takes and shows it in an overlay.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SFML/Graphics.hpp>
+#include "Allocations.hpp"
+#include "Assets.hpp"
+#include <array>
+#include <chrono>
+#include <string>
+
+/* CLASS Profiler
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Keeps the time of every phase for the last frames, measured with
+ * the steady clock. A phase can run several times in one frame, since
+ * the Field is updated in fixed steps, and then its times are added.
+ * The overlay shows the average, median and 99th percentile of every
+ * phase, its average number of allocations per frame and a graph of
+ * the frame times.
+ *
+ * CONSTRUCTORS
+ * Profiler(), default constructor
+ * Scope(Profiler &, Phase), measures a phase until it is destroyed
+ *
+ * OPERATIONS
+ * end_frame, input none, output none
+ * add, input Phase, duration, uint64_t, output none
+ * toggle, input none, output none
+ * is_visible, input none, output bool
+ * draw, input RenderWindow &, output none
+ * get_frame_time, input none, output float, ms of the last frame
+ * get_phase_time, input Phase, output float, ms in the last frame
+ * phase_name, input Phase, output string
+ *
+ * DATA MEMBERS
+ * array<array<float, history>, phase_count + 1> samples, in ms,
+ *     the last row is the whole frame
+ * array<duration, phase_count> current, the frame being measured
+ * array<array<uint32_t, history>, phase_count> allocation_samples
+ * array<uint64_t, phase_count> current_allocations
+ * time_point frame_start
+ * size_t frame, index of the next sample
+ * size_t frame_count
+ * bool visible
+ * sf::Text text
+ * sf::RectangleShape background
+ */
+
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Phase
+    {
+	EVENTS, PROJECTILES, ACTORS, SHOOTING, COLLISION, DRAW, DISPLAY,
+	PHASE_COUNT
+    };
+
+    class Scope
+    {
+    public:
+	Scope(Profiler &, Phase);
+	~Scope();
+	Scope(Scope const &) = delete;
+	Scope & operator=(Scope const &) = delete;
+    private:
+	Profiler & profiler;
+	Phase phase;
+	Clock::time_point start;
+	uint64_t allocations;
+    };
+
+    Profiler();
+    void end_frame();
+    void add(Phase, Clock::duration, uint64_t = 0);
+    void toggle();
+    bool is_visible() const;
+    void draw(sf::RenderWindow &);
+    float get_frame_time() const;
+    float get_phase_time(Phase) const;
+    static std::string phase_name(Phase);
+private:
+    static std::size_t const history{240};
+
+    void update_text();
+
+    std::array<std::array<float, history>, PHASE_COUNT + 1> samples{};
+    std::array<Clock::duration, PHASE_COUNT> current{};
+    std::array<std::array<uint32_t, history>, PHASE_COUNT> allocation_samples{};
+    std::array<uint64_t, PHASE_COUNT> current_allocations{};
+    Clock::time_point frame_start{Clock::now()};
+    std::size_t frame{};
+    std::size_t frame_count{};
+    bool visible{false};
+    sf::Text text{};
+    sf::RectangleShape background{};
+};
+
+#endif
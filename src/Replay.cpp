@@ -0,0 +1,481 @@
+/*
+ * IDENTIFICATION
+ * File name:  Replay.cpp
+ * Type:       Definitions for module Replay
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Replay and Recorder classes.
+ */
+
+#include "Replay.hpp"
+#include "Game_State.hpp"
+#include "State_Stream.hpp"
+#include <fstream>
+#include <iterator>
+
+// A day of game time, longer replays are taken to be broken
+#define frame_limit (24 * 60 * 60 * 60)
+
+using namespace std;
+
+/*
+ * --------------------------------------------------
+ * --------------------- REPLAY ---------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Replay(unsigned, Difficulty const &)
+ *
+ * Constructor for an empty replay of a game with the seed
+ * and difficulty.
+ */
+
+Replay::Replay(unsigned seed_init, Difficulty const & difficulty_init) :
+    seed{seed_init}, difficulty{difficulty_init}
+{
+}
+
+/*
+ * FUNCTION load(string const &)
+ *
+ * Reads a replay file. Every count is checked before room is made
+ * for it: a count of things that take at least a byte each can not
+ * be more than the bytes left, and a replay can not be longer than
+ * frame_limit frames.
+ */
+
+Replay Replay::load(string const & file)
+{
+    ifstream in_file{file, ios::binary};
+    if (!in_file)
+	throw invalid_argument("Replay " + file + " not found!");
+
+    string in{istreambuf_iterator<char>(in_file), istreambuf_iterator<char>()};
+
+    if (in.compare(0, 4, "PSIR") != 0)
+	throw invalid_argument(file + " is not a replay!");
+
+    State_Reader reader{in, 4};
+    uint64_t version = reader.read();
+
+    if (version < 1 || version > latest_version)
+	throw invalid_argument("Unknown replay version in " + file + "!");
+
+    Replay replay{};
+    replay.version = version;
+    replay.seed = reader.read();
+    replay.difficulty.enemy_columns = reader.read();
+    replay.difficulty.enemy_rows = reader.read();
+    replay.difficulty.enemy_shot_chance = reader.read();
+    replay.difficulty.enemy_shot_delay = reader.read_float();
+    replay.difficulty.boss_interval = reader.read_float();
+
+    if (reader.read() != uint64_t(Field::tick.asMicroseconds()))
+	throw invalid_argument(file + " was recorded with another frame length!");
+
+    uint64_t frame_count = reader.read();
+    uint64_t run_count = reader.read();
+
+    if (frame_count > frame_limit || run_count > in.size() - reader.get_position())
+	throw invalid_argument("Replay file is broken!");
+
+    replay.frames.reserve(frame_count);
+    for (uint64_t run{}; run < run_count; ++run)
+    {
+	uint64_t value = reader.read();
+	uint64_t length = value >> 4;
+
+	if (length > frame_count - replay.frames.size())
+	    throw invalid_argument("Replay file is broken!");
+	replay.frames.insert(end(replay.frames), length, value & 0xf);
+    }
+
+    if (replay.frames.size() != frame_count)
+	throw invalid_argument("Replay file is broken!");
+
+    uint64_t pause_count = reader.read();
+    uint32_t pause{};
+
+    if (pause_count > in.size() - reader.get_position())
+	throw invalid_argument("Replay file is broken!");
+
+    replay.pauses.reserve(pause_count);
+    for (uint64_t count{}; count < pause_count; ++count)
+    {
+	pause += reader.read();
+	replay.pauses.push_back(pause);
+    }
+
+    if (version == 1)
+	return replay;
+
+    replay.interval = reader.read();
+    uint64_t keyframe_count = reader.read();
+
+    if (keyframe_count > in.size() - reader.get_position())
+	throw invalid_argument("Replay file is broken!");
+
+    vector<uint64_t> sizes(keyframe_count);
+
+    for (uint64_t & size : sizes)
+	size = reader.read();
+
+    if (version >= 3)
+    {
+	replay.hash_interval = version >= 4 ? reader.read() : 1;
+	string bytes{reader.read_bytes()};
+
+	if (replay.hash_interval == 0 || bytes.size() % 4 != 0 ||
+	    bytes.size() / 4 > frame_count / replay.hash_interval)
+	    throw invalid_argument("Replay file is broken!");
+
+	for (size_t byte{}; byte < bytes.size(); byte += 4)
+	{
+	    uint32_t hash{};
+	    for (size_t shift{}; shift < 4; ++shift)
+		hash |= uint32_t(uint8_t(bytes[byte + shift])) << (8 * shift);
+	    replay.hashes.push_back(hash);
+	}
+    }
+
+    size_t position = reader.get_position();
+    for (uint64_t size : sizes)
+    {
+	if (size > in.size() - position)
+	    throw invalid_argument("Replay file is cut off!");
+
+	replay.keyframes.push_back(in.substr(position, size));
+	position += size;
+    }
+
+    return replay;
+}
+
+/*
+ * FUNCTION save(string const &)
+ *
+ * Writes the replay to file, frames with the same keys are
+ * written together as a run.
+ */
+
+void Replay::save(string const & file) const
+{
+    State_Writer runs{};
+    uint64_t run_count{};
+
+    for (size_t frame{}; frame < frames.size(); )
+    {
+	size_t length{1};
+	while (frame + length < frames.size() && frames[frame + length] == frames[frame])
+	    ++length;
+
+	runs.write((uint64_t(length) << 4) | (frames[frame] & 0xf));
+	++run_count;
+	frame += length;
+    }
+
+    State_Writer writer{};
+    writer.write(latest_version);
+    writer.write(seed);
+    writer.write(difficulty.enemy_columns);
+    writer.write(difficulty.enemy_rows);
+    writer.write(difficulty.enemy_shot_chance);
+    writer.write_float(difficulty.enemy_shot_delay);
+    writer.write_float(difficulty.boss_interval);
+    writer.write(Field::tick.asMicroseconds());
+    writer.write(frames.size());
+    writer.write(run_count);
+
+    State_Writer end_part{};
+    end_part.write(pauses.size());
+    uint32_t previous{};
+    for (uint32_t pause : pauses)
+    {
+	end_part.write(pause - previous);
+	previous = pause;
+    }
+
+    end_part.write(interval);
+    end_part.write(keyframes.size());
+    for (string const & keyframe : keyframes)
+	end_part.write(keyframe.size());
+
+    end_part.write(hash_interval);
+    string hash_bytes{};
+    hash_bytes.reserve(4 * hashes.size());
+    for (uint32_t hash : hashes)
+	for (size_t shift{}; shift < 4; ++shift)
+	    hash_bytes += char(hash >> (8 * shift));
+    end_part.write_bytes(hash_bytes);
+
+    ofstream out_file{file, ios::binary};
+    out_file << "PSIR" << writer.get_data() << runs.get_data() << end_part.get_data();
+    for (string const & keyframe : keyframes)
+	out_file << keyframe;
+
+    if (!out_file)
+	throw invalid_argument("Could not write replay " + file + "!");
+}
+
+/*
+ * FUNCTION add_frame(unsigned)
+ *
+ * Adds the held keys of one more frame.
+ */
+
+void Replay::add_frame(unsigned keys)
+{
+    frames.push_back(keys);
+}
+
+/*
+ * FUNCTION add_pause()
+ *
+ * Marks that the game was paused after the last frame.
+ */
+
+void Replay::add_pause()
+{
+    pauses.push_back(frames.size());
+}
+
+/*
+ * FUNCTION hash_due()
+ *
+ * True if the last frame added is the last of a hash interval, so
+ * that the state hash after it is to be added.
+ */
+
+bool Replay::hash_due() const
+{
+    return !frames.empty() && frames.size() % hash_interval == 0;
+}
+
+/*
+ * FUNCTION add_hash(uint32_t)
+ *
+ * Adds the state hash of the Field after the last frame.
+ */
+
+void Replay::add_hash(uint32_t hash)
+{
+    hashes.push_back(hash);
+}
+
+/*
+ * FUNCTION reserve(size_t)
+ *
+ * Makes room for at least ahead more frames, pauses and hashes, at
+ * least doubling the room when it grows, so that adding them does
+ * not allocate.
+ */
+
+void Replay::reserve(size_t ahead)
+{
+    if (frames.capacity() - frames.size() < ahead)
+	frames.reserve(2 * frames.size() + ahead);
+    if (pauses.capacity() - pauses.size() < ahead)
+	pauses.reserve(2 * pauses.size() + ahead);
+    if (hashes.capacity() - hashes.size() < ahead)
+	hashes.reserve(2 * hashes.size() + ahead);
+}
+
+/*
+ * FUNCTION play(Field &)
+ *
+ * Plays every frame of the replay on a new Field, created with
+ * the seed and difficulty of the replay.
+ */
+
+void Replay::play(Field & field) const
+{
+    sf::Time delta{Field::tick};
+
+    field.set_input(make_unique<Replay_Input>(frames));
+
+    for (size_t frame{}; frame < frames.size(); ++frame)
+	field.update(delta);
+}
+
+/*
+ * FUNCTION add_keyframes(Field &, unsigned)
+ *
+ * Plays the replay on a new Field and saves its state every
+ * interval frames.
+ */
+
+void Replay::add_keyframes(Field & field, unsigned new_interval)
+{
+    if (new_interval == 0)
+	throw invalid_argument("The keyframe interval must be positive!");
+
+    sf::Time delta{Field::tick};
+
+    interval = new_interval;
+    keyframes.clear();
+    field.set_input(make_unique<Replay_Input>(frames));
+
+    for (size_t frame{}; frame < frames.size(); ++frame)
+    {
+	if (frame > 0 && frame % interval == 0)
+	    keyframes.push_back(field.save_state());
+
+	field.update(delta);
+    }
+}
+
+/*
+ * FUNCTION seek(Field &, size_t)
+ *
+ * Brings a new Field to the state before frame, by loading the
+ * keyframe before it and playing from there. After seek the Field
+ * plays the rest of the replay when it is updated.
+ */
+
+void Replay::seek(Field & field, size_t frame) const
+{
+    sf::Time delta{Field::tick};
+    size_t start{};
+
+    frame = min(frame, frames.size());
+
+    if (interval > 0 && frame >= interval && !keyframes.empty())
+    {
+	size_t keyframe = min<size_t>(frame / interval, keyframes.size());
+	field.load_state(keyframes.at(keyframe - 1));
+	start = keyframe * interval;
+    }
+
+    field.set_input(make_unique<Replay_Input>(frames, start));
+
+    for (; start < frame; ++start)
+	field.update(delta);
+}
+
+/*
+ * FUNCTION get_version()
+ *
+ * Returns the version of the file the replay was loaded from.
+ */
+
+unsigned Replay::get_version() const
+{
+    return version;
+}
+
+/*
+ * FUNCTION get_seed()
+ *
+ * Returns the seed of the game.
+ */
+
+unsigned Replay::get_seed() const
+{
+    return seed;
+}
+
+/*
+ * FUNCTION get_difficulty()
+ *
+ * Returns the difficulty of the game.
+ */
+
+Difficulty Replay::get_difficulty() const
+{
+    return difficulty;
+}
+
+/*
+ * FUNCTION get_frames()
+ *
+ * Returns the keys of every frame.
+ */
+
+vector<uint8_t> const & Replay::get_frames() const
+{
+    return frames;
+}
+
+/*
+ * FUNCTION get_pauses()
+ *
+ * Returns the frames where the game was paused.
+ */
+
+vector<uint32_t> const & Replay::get_pauses() const
+{
+    return pauses;
+}
+
+/*
+ * FUNCTION get_hashes()
+ *
+ * Returns the state hash after every hash interval, if it was
+ * recorded.
+ */
+
+vector<uint32_t> const & Replay::get_hashes() const
+{
+    return hashes;
+}
+
+/*
+ * FUNCTION get_hash_interval()
+ *
+ * Returns the number of frames between two state hashes.
+ */
+
+unsigned Replay::get_hash_interval() const
+{
+    return hash_interval;
+}
+
+/*
+ * --------------------------------------------------
+ * -------------------- RECORDER --------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION Recorder(unique_ptr<Input_Source>, Replay &)
+ *
+ * Constructor for Recorder, takes the input source to record
+ * and the replay to record to.
+ */
+
+Recorder::Recorder(unique_ptr<Input_Source> input_init, Replay & replay_init) :
+    input{move(input_init)}, replay(replay_init)
+{
+}
+
+/*
+ * FUNCTION handle_input(sf::Event &)
+ *
+ * Passes the event on and records pauses.
+ */
+
+void Recorder::handle_input(sf::Event & event)
+{
+    if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::P)
+	replay.add_pause();
+
+    input -> handle_input(event);
+}
+
+/*
+ * FUNCTION next_keys(sf::Time const &)
+ *
+ * Returns and records the keys of the recorded input source.
+ */
+
+unsigned Recorder::next_keys(sf::Time const & delta)
+{
+    unsigned keys = input -> next_keys(delta);
+    replay.add_frame(keys);
+    return keys;
+}
@@ -0,0 +1,180 @@
+/*
+ * IDENTIFICATION
+ * File name:  Replay.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Replay class, a recorded game that can be
+ * saved, loaded and played again exactly, and the Recorder class
+ * which records the keys of a game.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Actor.hpp"
+#include "Input_Source.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Field;
+
+/* CLASS Replay
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * The seed, the difficulty and the held keys of every frame of a
+ * game, plus the frames where the game was paused. Since the Field
+ * is updated in fixed steps this is all that is needed to play the
+ * game again.
+ *
+ * A replay can also hold keyframes, saved Field states every interval
+ * frames, so that seek only has to play from the keyframe before.
+ *
+ * A recorded game also holds the state hash of the Field after every
+ * hash_interval frames, a second of game time, so that a replay
+ * played again on another machine can be checked as it goes, and the
+ * second where the game went another way than when it was recorded
+ * found. Four bytes a second keep the replay small, and the Field is
+ * only written out for a hash once a second.
+ *
+ * FILE FORMAT
+ * Written with State_Writer: numbers are varints, floats are four
+ * bytes little endian.
+ *   "PSIR", version (latest_version, 4)
+ *   seed, columns, rows, shot chance, shot delay, boss interval
+ *   frame length in microseconds, number of frames
+ *   number of runs, then per run: (length << 4) | keys
+ *   number of pauses, then the frame of each pause as the
+ *   difference from the previous pause
+ *   keyframe interval, number of keyframes, then the index with the
+ *   size of each keyframe
+ *   hash interval, then the state hashes, four bytes little endian
+ *   each, written as bytes with their length first
+ *   the keyframe states one after another
+ * Version 1 files have no keyframe part, version 2 files no state
+ * hashes, and version 3 files a hash after every frame without the
+ * hash interval.
+ *
+ * CONSTRUCTORS
+ * Replay(), default constructor.
+ * Replay(unsigned, Difficulty const &)
+ *
+ * OPERATIONS
+ * load, input string const &, output Replay (static)
+ * save, input string const &, output none
+ * add_frame, input unsigned, output none
+ * add_pause, input none, output none
+ * hash_due, input none, output bool, true if the last frame added
+ *     ends a hash interval
+ * add_hash, input uint32_t, output none, the state hash after the
+ *     last frame
+ * reserve, input size_t, output none, makes room for at least that
+ *     many more frames, pauses and hashes
+ * play, input Field &, output none
+ * add_keyframes, input Field &, unsigned, output none
+ * seek, input Field &, size_t, output none
+ * get_version, input none, output unsigned, the version of the file
+ *     the replay was loaded from, latest_version for a new replay
+ * get_seed, input none, output unsigned
+ * get_difficulty, input none, output Difficulty
+ * get_frames, input none, output vector<uint8_t> const &
+ * get_pauses, input none, output vector<uint32_t> const &
+ * get_hashes, input none, output vector<uint32_t> const &, empty for
+ *     replays recorded without them
+ * get_hash_interval, input none, output unsigned
+ *
+ * DATA MEMBERS
+ * unsigned version
+ * unsigned seed
+ * Difficulty difficulty
+ * vector<uint8_t> frames
+ * vector<uint32_t> pauses
+ * vector<uint32_t> hashes, hash n is the state after frame
+ *                          (n + 1) * hash_interval - 1
+ * unsigned hash_interval
+ * unsigned interval
+ * vector<string> keyframes, keyframe n is the state before
+ *                           frame (n + 1) * interval
+ */
+
+class Replay
+{
+public:
+    static unsigned const latest_version{4};
+    static unsigned const default_hash_interval{60};
+
+    Replay() = default;
+    Replay(unsigned, Difficulty const &);
+    ~Replay() = default;
+    static Replay load(std::string const &);
+    void save(std::string const &) const;
+    void add_frame(unsigned);
+    void add_pause();
+    bool hash_due() const;
+    void add_hash(uint32_t);
+    void reserve(std::size_t);
+    void play(Field &) const;
+    void add_keyframes(Field &, unsigned);
+    void seek(Field &, std::size_t) const;
+    unsigned get_version() const;
+    unsigned get_seed() const;
+    Difficulty get_difficulty() const;
+    std::vector<uint8_t> const & get_frames() const;
+    std::vector<uint32_t> const & get_pauses() const;
+    std::vector<uint32_t> const & get_hashes() const;
+    unsigned get_hash_interval() const;
+private:
+    unsigned version{latest_version};
+    unsigned seed{};
+    Difficulty difficulty{};
+    std::vector<uint8_t> frames{};
+    std::vector<uint32_t> pauses{};
+    std::vector<uint32_t> hashes{};
+    unsigned hash_interval{default_hash_interval};
+    unsigned interval{};
+    std::vector<std::string> keyframes{};
+};
+
+/* CLASS Recorder
+ *
+ * PARENT CLASS
+ * Input_Source
+ *
+ * DESCRIPTION
+ * Passes on the keys of another input source and adds them to
+ * a replay. A release of the pause key P is added as a pause.
+ *
+ * CONSTRUCTORS
+ * Recorder(unique_ptr<Input_Source>, Replay &)
+ *
+ * OPERATIONS
+ * handle_input, input Event &, output none
+ * next_keys, input Time const &, output unsigned
+ *
+ * DATA MEMBERS
+ * unique_ptr<Input_Source> input
+ * Replay & replay
+ */
+
+class Recorder : public Input_Source
+{
+public:
+    Recorder(std::unique_ptr<Input_Source>, Replay &);
+    ~Recorder() = default;
+    void handle_input(sf::Event &) override;
+    unsigned next_keys(sf::Time const &) override;
+private:
+    std::unique_ptr<Input_Source> input{};
+    Replay & replay;
+};
+
+#endif
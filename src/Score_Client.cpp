@@ -0,0 +1,344 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Client.cpp
+ * Type:       Definitions for module Score_Client
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Client class, which sends the scores
+ * of a game to the leaderboard server and fetches its best rows.
+ */
+
+#include "Score_Client.hpp"
+#include <random>
+#include <stdexcept>
+
+#define batch_interval std::chrono::milliseconds(100)
+#define refresh_interval std::chrono::seconds(1)
+#define retry_interval std::chrono::seconds(3)
+#define connect_timeout sf::milliseconds(500)
+#define reply_timeout sf::seconds(10)
+#define pending_limit 100000
+#define longest_row 260
+
+using namespace std;
+
+/*
+ * FUNCTION Score_Client(string const &, unsigned short, unsigned)
+ *
+ * Constructor for Score_Client, picks the id of the game and starts
+ * the thread that connects to the server.
+ */
+
+Score_Client::Score_Client(string const & host_init, unsigned short port_init,
+			   unsigned rows_init) :
+    host{host_init}, port{port_init}, rows_wanted{rows_init}
+{
+    random_device random{};
+    game_id = uint64_t(random()) << 32 | random();
+
+    worker = thread{&Score_Client::run, this};
+}
+
+/*
+ * FUNCTION ~Score_Client()
+ *
+ * Destructor for Score_Client. Wakes the thread, which makes one
+ * last try to send the queued scores, and waits for it.
+ */
+
+Score_Client::~Score_Client()
+{
+    {
+	lock_guard<mutex> lock{wake_mutex};
+	stopping = true;
+    }
+    wake.notify_one();
+
+    worker.join();
+}
+
+/*
+ * FUNCTION submit(string const &, int)
+ *
+ * Queues a score for the server. The oldest scores are dropped when
+ * too many are queued, the top list file still has them.
+ */
+
+void Score_Client::submit(string const & alias, int score)
+{
+    lock_guard<mutex> lock{queue_mutex};
+
+    if (queue.size() >= pending_limit)
+	queue.pop_front();
+
+    queue.emplace_back(alias, score);
+}
+
+/*
+ * FUNCTION take_rows(Rows &)
+ *
+ * Gives the best rows of the server if they changed since the last
+ * call. No rows means that the server can not be reached.
+ */
+
+bool Score_Client::take_rows(Rows & taken)
+{
+    lock_guard<mutex> lock{rows_mutex};
+
+    if (!fresh)
+	return false;
+
+    taken = rows;
+    fresh = false;
+    return true;
+}
+
+/*
+ * FUNCTION get_acknowledged()
+ *
+ * Returns the number of scores the server has saved.
+ */
+
+uint64_t Score_Client::get_acknowledged() const
+{
+    return acknowledged;
+}
+
+/*
+ * FUNCTION run()
+ *
+ * The client thread. Talks to the server every batch_interval until
+ * it is stopped, and then once more without waiting for a retry.
+ */
+
+void Score_Client::run()
+{
+    while (!stopping)
+    {
+	exchange();
+
+	unique_lock<mutex> lock{wake_mutex};
+	wake.wait_for(lock, batch_interval, [this]() { return bool{stopping}; });
+    }
+
+    last_attempt = Clock::time_point{};
+    exchange();
+    disconnect();
+}
+
+/*
+ * FUNCTION exchange()
+ *
+ * Sends the batches not yet answered, or else the queued scores, and
+ * fetches the best rows when they were sent or the rows are old. On
+ * any error the batches are kept to be sent again as they are, and
+ * the connection is closed.
+ */
+
+void Score_Client::exchange()
+{
+    if (!connected && !connect())
+	return;
+
+    if (unacknowledged.empty())
+	take_batches();
+
+    bool refresh{!unacknowledged.empty() || Clock::now() - last_refresh >= refresh_interval};
+    bool done{false};
+
+    try
+    {
+	done = (unacknowledged.empty() || send_scores()) &&
+	    (!refresh || stopping || fetch_rows());
+    }
+    catch (invalid_argument const &)
+    {
+    }
+
+    if (!done)
+	disconnect();
+}
+
+/*
+ * FUNCTION take_batches()
+ *
+ * Takes the queued scores and makes them numbered batches, as few as
+ * the body limit allows.
+ */
+
+void Score_Client::take_batches()
+{
+    deque<Rows::value_type> taken{};
+    {
+	lock_guard<mutex> lock{queue_mutex};
+	taken.swap(queue);
+    }
+
+    string body{};
+
+    for (auto && row : taken)
+    {
+	if (body.empty())
+	{
+	    Score_Protocol::add_u64(body, game_id);
+	    Score_Protocol::add_u32(body, next_batch++);
+	}
+
+	Score_Protocol::add_row(body, row.first, row.second);
+
+	if (body.size() + longest_row > Score_Protocol::body_limit)
+	{
+	    unacknowledged.push_back(move(body));
+	    body.clear();
+	}
+    }
+
+    if (!body.empty())
+	unacknowledged.push_back(move(body));
+}
+
+/*
+ * FUNCTION connect()
+ *
+ * Connects to the server, at most once every retry_interval.
+ */
+
+bool Score_Client::connect()
+{
+    if (Clock::now() - last_attempt < retry_interval)
+	return false;
+
+    last_attempt = Clock::now();
+
+    if (socket.connect(host, port, connect_timeout) != sf::Socket::Done)
+	return false;
+
+    connected = true;
+    input.clear();
+    last_refresh = Clock::time_point{};
+    return true;
+}
+
+/*
+ * FUNCTION disconnect()
+ *
+ * Closes the connection, and clears the rows so that the top list
+ * shows its own file.
+ */
+
+void Score_Client::disconnect()
+{
+    socket.disconnect();
+    connected = false;
+    set_rows(Rows{});
+}
+
+/*
+ * FUNCTION send_scores()
+ *
+ * Sends the batches not yet answered, and waits for the server to
+ * answer them. A batch is dropped once it is answered.
+ */
+
+bool Score_Client::send_scores()
+{
+    string output{};
+
+    for (string const & body : unacknowledged)
+	Score_Protocol::add_message(output, Score_Protocol::SUBMIT, body);
+
+    if (socket.send(output.data(), output.size()) != sf::Socket::Done)
+	return false;
+
+    while (!unacknowledged.empty())
+    {
+	string reply{};
+	size_t offset{};
+
+	if (!receive(Score_Protocol::ACK, reply))
+	    return false;
+
+	acknowledged += Score_Protocol::read_u32(reply, offset);
+	unacknowledged.pop_front();
+    }
+
+    return true;
+}
+
+/*
+ * FUNCTION fetch_rows()
+ *
+ * Asks the server for its best rows.
+ */
+
+bool Score_Client::fetch_rows()
+{
+    string body{};
+    string message{};
+    string reply{};
+    size_t offset{};
+
+    Score_Protocol::add_u16(body, rows_wanted);
+    Score_Protocol::add_message(message, Score_Protocol::TOP, body);
+
+    if (socket.send(message.data(), message.size()) != sf::Socket::Done ||
+	!receive(Score_Protocol::ROWS, reply))
+	return false;
+
+    // The size of the list comes first
+    Score_Protocol::read_u32(reply, offset);
+    set_rows(Score_Protocol::read_rows(reply, offset));
+
+    last_refresh = Clock::now();
+    return true;
+}
+
+/*
+ * FUNCTION receive(Type, string &)
+ *
+ * Waits for the next message, at most reply_timeout for every part
+ * of it, and returns true if it has the type expected.
+ */
+
+bool Score_Client::receive(Score_Protocol::Type expected, string & body)
+{
+    sf::SocketSelector selector{};
+    selector.add(socket);
+
+    Score_Protocol::Type type{};
+    char buffer[4096];
+
+    while (!Score_Protocol::take_message(input, type, body))
+    {
+	size_t received{};
+
+	if (!selector.wait(reply_timeout) ||
+	    socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Done)
+	    return false;
+
+	input.append(buffer, received);
+    }
+
+    return type == expected;
+}
+
+/*
+ * FUNCTION set_rows(Rows)
+ *
+ * Hands new rows to the game thread, if they differ from the last.
+ */
+
+void Score_Client::set_rows(Rows new_rows)
+{
+    lock_guard<mutex> lock{rows_mutex};
+
+    if (new_rows == rows)
+	return;
+
+    rows = move(new_rows);
+    fresh = true;
+}
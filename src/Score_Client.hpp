@@ -0,0 +1,136 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Client.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Client class, which sends the scores
+ * of a game to the leaderboard server and fetches its best rows.
+ */
+
+#ifndef SCORE_CLIENT_H
+#define SCORE_CLIENT_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Score_Protocol.hpp"
+
+/* CLASS Score_Client
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Talks to a Score_Server from a thread of its own, so the game
+ * thread never waits for the network. submit only adds the score
+ * to a queue. Every batch_interval the thread sends the queued
+ * scores in one message, and after that, or once a second, asks for
+ * the best rows, which the game thread picks up with take_rows.
+ *
+ * When the server can not be reached, or does not answer in time,
+ * the scores stay queued, at most pending_limit of them, and the
+ * thread tries again every few seconds. take_rows then gives no
+ * rows, so that the top list shows its own file instead. The
+ * destructor makes one last try to send what is queued.
+ *
+ * Every batch is numbered and sent with a random id of the game. A
+ * batch whose answer was lost is sent again as it was, and the
+ * server saves it only if it has not seen its number before. A
+ * server restarted in between may save it twice.
+ *
+ * CONSTRUCTORS
+ * Score_Client(string const &, unsigned short, unsigned), the host
+ *     and port of the server, and the number of rows to fetch
+ *
+ * OPERATIONS
+ * submit, input string const &, int, output none
+ * take_rows, input Rows &, output bool, the best rows of the server,
+ *     none when it can not be reached, true if they changed since
+ *     the last call
+ * get_acknowledged, input none, output uint64_t, the scores the
+ *     server has saved
+ *
+ * DATA MEMBERS
+ * string host
+ * unsigned short port
+ * unsigned rows_wanted
+ * mutex queue_mutex, only held to add or take scores
+ * deque<pair<string, int>> queue
+ * uint64_t game_id
+ * uint32_t next_batch
+ * deque<string> unacknowledged, the SUBMIT bodies sent or to send
+ *     that the server has not answered
+ * mutex rows_mutex, only held to set or take the rows
+ * Rows rows
+ * bool fresh, true when the rows changed since take_rows
+ * TcpSocket socket
+ * bool connected
+ * string input, bytes received that are not a whole message yet
+ * time_point last_attempt, of connecting
+ * time_point last_refresh, of the rows
+ * atomic<uint64_t> acknowledged
+ * atomic<bool> stopping
+ * mutex wake_mutex
+ * condition_variable wake
+ * thread worker
+ */
+
+class Score_Client
+{
+public:
+    using Rows = Score_Protocol::Rows;
+
+    Score_Client(std::string const &, unsigned short, unsigned);
+    ~Score_Client();
+    Score_Client(Score_Client const &) = delete;
+    Score_Client & operator=(Score_Client const &) = delete;
+    void submit(std::string const &, int);
+    bool take_rows(Rows &);
+    std::uint64_t get_acknowledged() const;
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+    void exchange();
+    bool connect();
+    void disconnect();
+    void take_batches();
+    bool send_scores();
+    bool fetch_rows();
+    bool receive(Score_Protocol::Type, std::string &);
+    void set_rows(Rows);
+
+    std::string host{};
+    unsigned short port{};
+    unsigned rows_wanted{};
+    std::mutex queue_mutex{};
+    std::deque<Rows::value_type> queue{};
+    std::uint64_t game_id{};
+    std::uint32_t next_batch{1};
+    std::deque<std::string> unacknowledged{};
+    std::mutex rows_mutex{};
+    Rows rows{};
+    bool fresh{false};
+    sf::TcpSocket socket{};
+    bool connected{false};
+    std::string input{};
+    Clock::time_point last_attempt{};
+    Clock::time_point last_refresh{};
+    std::atomic<std::uint64_t> acknowledged{0};
+    std::atomic<bool> stopping{false};
+    std::mutex wake_mutex{};
+    std::condition_variable wake{};
+    std::thread worker{};
+};
+
+#endif
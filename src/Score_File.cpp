@@ -0,0 +1,304 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_File.cpp
+ * Type:       Definitions for module Score_File
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_File class, the binary top list file
+ * that is mapped to memory and read where it lies.
+ */
+
+#include "Score_File.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define file_magic "PSIT"
+#define file_version 1
+
+using namespace std;
+
+/*
+ * FUNCTION better(int, string_view, int, string_view)
+ *
+ * True if the first score and alias come before the second, the
+ * higher score first and equal scores by alias.
+ */
+
+static bool better(int score, string_view alias, int other_score, string_view other_alias)
+{
+    if (score == other_score)
+	return alias < other_alias;
+    return score > other_score;
+}
+
+/*
+ * FUNCTION Score_File(string const &)
+ *
+ * Constructor for Score_File, maps the file. A file that does not
+ * exist gives an empty list.
+ */
+
+Score_File::Score_File(string const & file)
+{
+    int descriptor{open(file.c_str(), O_RDONLY)};
+
+    if (descriptor < 0)
+    {
+	if (errno == ENOENT)
+	    return;
+	throw invalid_argument("Could not open " + file + "!");
+    }
+
+    struct stat status{};
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+    {
+	close(descriptor);
+	return;
+    }
+
+    length = status.st_size;
+    mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+	mapping = nullptr;
+	throw invalid_argument("Could not map " + file + "!");
+    }
+
+    header = static_cast<Header const *>(mapping);
+
+    // Only the sizes are checked, so that opening does not read the file
+    if (length < sizeof(Header) || memcmp(header -> magic, file_magic, 4) != 0 ||
+	header -> version != file_version ||
+	header -> count > (length - sizeof(Header)) / (sizeof(Entry) + sizeof(uint32_t)) ||
+	length != sizeof(Header) + header -> count * (sizeof(Entry) + sizeof(uint32_t)) +
+	header -> strings_size)
+    {
+	munmap(mapping, length);
+	mapping = nullptr;
+	header = nullptr;
+	throw invalid_argument(file + " is not a top list file!");
+    }
+
+    entries = reinterpret_cast<Entry const *>(header + 1);
+    by_alias = reinterpret_cast<uint32_t const *>(entries + header -> count);
+    strings = reinterpret_cast<char const *>(by_alias + header -> count);
+}
+
+/*
+ * FUNCTION ~Score_File()
+ *
+ * Destructor for Score_File, unmaps the file.
+ */
+
+Score_File::~Score_File()
+{
+    if (mapping)
+	munmap(mapping, length);
+}
+
+/*
+ * FUNCTION size()
+ *
+ * Returns the number of entries.
+ */
+
+size_t Score_File::size() const
+{
+    return header ? header -> count : 0;
+}
+
+/*
+ * FUNCTION alias(size_t)
+ *
+ * Returns the alias of the entry at a rank. A rank outside the
+ * entries, or an alias outside the strings, of a damaged file is
+ * empty.
+ */
+
+string_view Score_File::alias(size_t rank) const
+{
+    if (rank >= size())
+	return string_view{};
+
+    Entry const & entry{entries[rank]};
+
+    if (entry.offset > header -> strings_size ||
+	entry.length > header -> strings_size - entry.offset)
+	return string_view{};
+
+    return string_view{strings + entry.offset, entry.length};
+}
+
+/*
+ * FUNCTION score(size_t)
+ *
+ * Returns the score of the entry at a rank.
+ */
+
+int Score_File::score(size_t rank) const
+{
+    return entries[rank].score;
+}
+
+/*
+ * FUNCTION find(string_view)
+ *
+ * Returns the rank of an alias, or size() if it is not in the file.
+ * The index is only read where it is used, so one that is out of
+ * range in a damaged file is not found.
+ */
+
+size_t Score_File::find(string_view wanted) const
+{
+    uint32_t const * first{by_alias};
+    uint32_t const * last{by_alias + size()};
+
+    uint32_t const * found = lower_bound(first, last, wanted, [this](uint32_t index, string_view value)
+					 {
+					     return alias(index) < value;
+					 });
+
+    if (found == last || *found >= size() || alias(*found) != wanted)
+	return size();
+
+    return *found;
+}
+
+/*
+ * FUNCTION count_better(int, string_view)
+ *
+ * Returns the number of entries that come before a score and alias.
+ */
+
+size_t Score_File::count_better(int wanted_score, string_view wanted_alias) const
+{
+    size_t first{};
+    size_t last{size()};
+
+    while (first < last)
+    {
+	size_t middle{first + (last - first) / 2};
+
+	if (better(score(middle), alias(middle), wanted_score, wanted_alias))
+	    first = middle + 1;
+	else
+	    last = middle;
+    }
+
+    return first;
+}
+
+/*
+ * FUNCTION for_each(function<void(string_view, int)> const &)
+ *
+ * Calls the function for every alias and score, best first.
+ */
+
+void Score_File::for_each(function<void(string_view, int)> const & apply) const
+{
+    for (size_t rank{}; rank < size(); ++rank)
+	apply(alias(rank), score(rank));
+}
+
+/*
+ * FUNCTION write(string const &, Score_File const &, Changes const &)
+ *
+ * Writes the entries of a file, with the scores of the changes in
+ * place of their old ones, to a temporary file that is synced and
+ * renamed to the file. The old file may be the one replaced. Returns
+ * false if nothing was written.
+ */
+
+bool Score_File::write(string const & file, Score_File const & old, Changes const & changes)
+{
+    vector<pair<int, string_view>> changed{};
+    for (auto && change : changes)
+	changed.emplace_back(change.second, change.first);
+
+    sort(begin(changed), end(changed), [](auto const & item, auto const & other)
+	 {
+	     return better(item.first, item.second, other.first, other.second);
+	 });
+
+    // Both are ordered already, so they are merged
+    vector<pair<int, string_view>> rows{};
+    rows.reserve(old.size() + changed.size());
+
+    auto change = begin(changed);
+    for (size_t rank{}; rank < old.size(); ++rank)
+    {
+	string_view alias{old.alias(rank)};
+	if (changes.find(alias) != end(changes))
+	    continue;
+
+	for (; change != end(changed) &&
+		 better(change -> first, change -> second, old.score(rank), alias); ++change)
+	    rows.push_back(*change);
+
+	rows.emplace_back(old.score(rank), alias);
+    }
+    rows.insert(end(rows), change, end(changed));
+
+    if (rows.size() > UINT32_MAX)
+	return false;
+
+    vector<uint32_t> ordered(rows.size());
+    iota(begin(ordered), end(ordered), 0);
+    sort(begin(ordered), end(ordered), [&rows](uint32_t index, uint32_t other)
+	 {
+	     return rows[index].second < rows[other].second;
+	 });
+
+    Header header{{}, file_version, rows.size(), 0};
+    memcpy(header.magic, file_magic, 4);
+    for (auto && row : rows)
+	header.strings_size += row.second.size();
+
+    // Each process writes its own, when several fold at once
+    string temporary{file + ".tmp." + to_string(getpid())};
+    FILE * out{fopen(temporary.c_str(), "wb")};
+    if (!out)
+	return false;
+
+    fwrite(&header, sizeof(header), 1, out);
+
+    uint64_t offset{};
+    for (auto && row : rows)
+    {
+	Entry entry{row.first, uint32_t(row.second.size()), offset};
+	fwrite(&entry, sizeof(entry), 1, out);
+	offset += row.second.size();
+    }
+
+    fwrite(ordered.data(), sizeof(uint32_t), ordered.size(), out);
+
+    for (auto && row : rows)
+	fwrite(row.second.data(), 1, row.second.size(), out);
+
+    bool written{fflush(out) == 0 && !ferror(out) && fsync(fileno(out)) == 0};
+    fclose(out);
+
+    if (!written || rename(temporary.c_str(), file.c_str()) != 0)
+    {
+	remove(temporary.c_str());
+	return false;
+    }
+
+    return true;
+}
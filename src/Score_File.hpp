@@ -0,0 +1,118 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_File.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_File class, the binary top list file
+ * that is mapped to memory and read where it lies.
+ */
+
+#ifndef SCORE_FILE_H
+#define SCORE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+/* CLASS Score_File
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * A top list file that is mapped to memory read only, so opening it
+ * takes the same time whatever its size, nothing is copied, and the
+ * pages are shared through the page cache by every process that
+ * reads the same file. The file is, in the byte order of the machine:
+ *
+ *     header   "PSIT", version, count, size of the strings
+ *     entries  score, alias length, alias offset, best first
+ *     by_alias the index of every entry, ordered by alias
+ *     strings  the aliases, one after the other
+ *
+ * Entries are ordered by score, higher first, and equal scores by
+ * alias, so the best k are the first k entries and the rank of a
+ * score is found by binary search, as is an alias in by_alias.
+ *
+ * A file is never changed once written. write makes a new one from
+ * an old one and a map of changed scores, and puts it in place with
+ * a rename, so a mapped file stays whole until it is unmapped.
+ *
+ * CONSTRUCTORS
+ * Score_File(), an empty list
+ * Score_File(string const &), maps a file, empty if there is none
+ *
+ * OPERATIONS
+ * size, input none, output size_t
+ * alias, input size_t, output string_view, of the entry at a rank
+ *     counted from 0
+ * score, input size_t, output int, of the entry at a rank
+ * find, input string_view, output size_t, the rank of an alias
+ *     counted from 0, size() when it is not in the file
+ * count_better, input int, string_view, output size_t, the number of
+ *     entries better than a score and alias
+ * for_each, input function<void(string_view, int)>, output none,
+ *     calls the function for every entry, best first
+ * write, input string const &, Score_File const &, Changes const &,
+ *     output bool, (static) writes a file with the changes applied,
+ *     false if it could not be written
+ *
+ * DATA MEMBERS
+ * void * mapping
+ * size_t length, of the mapping
+ * Header const * header
+ * Entry const * entries
+ * uint32_t const * by_alias
+ * char const * strings
+ */
+
+class Score_File
+{
+public:
+    using Changes = std::map<std::string, int, std::less<>>;
+
+    Score_File() = default;
+    explicit Score_File(std::string const &);
+    ~Score_File();
+    Score_File(Score_File const &) = delete;
+    Score_File & operator=(Score_File const &) = delete;
+    std::size_t size() const;
+    std::string_view alias(std::size_t) const;
+    int score(std::size_t) const;
+    std::size_t find(std::string_view) const;
+    std::size_t count_better(int, std::string_view) const;
+    void for_each(std::function<void(std::string_view, int)> const &) const;
+    static bool write(std::string const &, Score_File const &, Changes const &);
+private:
+    struct Header
+    {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t count;
+	std::uint64_t strings_size;
+    };
+
+    struct Entry
+    {
+	std::int32_t score;
+	std::uint32_t length;
+	std::uint64_t offset;
+    };
+
+    void * mapping{nullptr};
+    std::size_t length{};
+    Header const * header{nullptr};
+    Entry const * entries{nullptr};
+    std::uint32_t const * by_alias{nullptr};
+    char const * strings{nullptr};
+};
+
+#endif
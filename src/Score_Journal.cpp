@@ -0,0 +1,496 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Journal.cpp
+ * Type:       Definitions for module Score_Journal
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Journal class which saves the scores
+ * of the Top_List as they come, and folds them into the top list
+ * file now and then.
+ */
+
+#include "Score_Journal.hpp"
+#include "Score_File.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define sync_records 32
+#define sync_interval std::chrono::seconds(1)
+#define poll_interval std::chrono::milliseconds(10)
+#define fold_records 4096
+#define time_separator '\t'
+
+using namespace std;
+
+/*
+ * FUNCTION Score_Journal(string const &, Apply const &, time_t)
+ *
+ * Constructor for Score_Journal. Reads the recent scores and the
+ * journals of the snapshot, opens the journal and starts the journal
+ * thread. If a fold was cut off, or the journal is already long, the
+ * thread starts with a fold.
+ */
+
+Score_Journal::Score_Journal(string const & snapshot_init, Apply const & apply,
+			     time_t keep_init) :
+    snapshot{snapshot_init}, journal{snapshot_init + ".journal"},
+    old_journal{snapshot_init + ".journal.old"}, lock_file{snapshot_init + ".lock"},
+    recent{snapshot_init + ".recent"}, keep{keep_init}
+{
+    if (!open_journal())
+	throw invalid_argument("Could not open " + journal + "!");
+
+    // No other game appends while the journal is read and cut
+    flock(descriptor, LOCK_EX);
+
+    read_scores(recent, apply);
+    read_scores(old_journal, apply);
+
+    off_t length = read_scores(journal, [this, &apply](string const & alias, int score,
+						       time_t time)
+		{
+		    apply(alias, score, time);
+		    ++records;
+		});
+
+    // A line cut off by a crash would be continued by the next append
+    bool truncated{ftruncate(descriptor, length) == 0};
+    flock(descriptor, LOCK_UN);
+
+    if (!truncated)
+    {
+	close(descriptor);
+	throw runtime_error("Could not truncate " + journal + "!");
+    }
+
+    fold_requested = ifstream{old_journal} || records >= fold_records;
+    writer = thread{&Score_Journal::run, this};
+}
+
+/*
+ * FUNCTION ~Score_Journal()
+ *
+ * Destructor for Score_Journal. Waits for the journal thread to
+ * write the scores left and sync the journal, but does not write
+ * the snapshot.
+ */
+
+Score_Journal::~Score_Journal()
+{
+    {
+	lock_guard<mutex> lock{wake_mutex};
+	stopping = true;
+    }
+    wake.notify_one();
+
+    writer.join();
+    close(descriptor);
+
+    if (lock_descriptor >= 0)
+	close(lock_descriptor);
+}
+
+/*
+ * FUNCTION append(string const &, int, time_t)
+ *
+ * Hands a score and the time it was made to the journal thread.
+ * Waits only while the ring is full.
+ */
+
+void Score_Journal::append(string const & alias, int score, time_t time)
+{
+    size_t tail{queue_tail.load(memory_order_relaxed)};
+
+    while (tail - queue_head.load(memory_order_acquire) >= queue_capacity)
+	this_thread::yield();
+
+    // The string keeps its memory when the record is used again
+    Record & record{queue[tail % queue_capacity]};
+    record.alias = alias;
+    record.score = score;
+    record.time = time;
+
+    queue_tail.store(tail + 1, memory_order_release);
+}
+
+/*
+ * FUNCTION read_scores(string const &, Apply const &)
+ *
+ * Calls apply for every "alias:score" line of a file, with the time
+ * after the tab that ends the line, or 0 if there is none. The alias
+ * is what comes before the last colon, so it may hold colons itself.
+ * A missing file has no lines. Returns the length of the lines read.
+ */
+
+off_t Score_Journal::read_scores(string const & file, Apply const & apply)
+{
+    ifstream in{file};
+    string line{};
+    off_t length{};
+
+    // A line that ends the file without a newline was cut off
+    while (getline(in, line) && !in.eof())
+    {
+	length += line.size() + 1;
+
+	try
+	{
+	    time_t time{};
+	    size_t separator{line.rfind(time_separator)};
+
+	    if (separator != string::npos)
+	    {
+		time = stoll(line.substr(separator + 1));
+		line.erase(separator);
+	    }
+
+	    size_t colon{line.rfind(':')};
+	    if (colon != string::npos)
+		apply(line.substr(0, colon), stoi(line.substr(colon + 1)), time);
+	}
+	catch (invalid_argument const &)
+	{
+	}
+	catch (out_of_range const &)
+	{
+	}
+    }
+
+    return length;
+}
+
+/*
+ * FUNCTION pop(Record &)
+ *
+ * Moves the oldest score of the ring to the record, or returns
+ * false if the ring is empty. Only called by the journal thread.
+ */
+
+bool Score_Journal::pop(Record & record)
+{
+    size_t head{queue_head.load(memory_order_relaxed)};
+
+    if (head == queue_tail.load(memory_order_acquire))
+	return false;
+
+    Record & next{queue[head % queue_capacity]};
+    record.alias.swap(next.alias);
+    record.score = next.score;
+    record.time = next.time;
+
+    queue_head.store(head + 1, memory_order_release);
+    return true;
+}
+
+/*
+ * FUNCTION run()
+ *
+ * The journal thread. Writes the scores of the ring to the journal,
+ * syncs it and folds it when it has grown long. Looks at the ring a
+ * short while at a time, and empties it once more after it is told
+ * to stop, so that every score appended is written.
+ */
+
+void Score_Journal::run()
+{
+    Record record{};
+
+    if (fold_requested)
+	fold();
+
+    while (true)
+    {
+	bool stop{stopping};
+	bool popped{false};
+
+	while (pop(record))
+	{
+	    pending += record.alias + ":" + to_string(record.score) + time_separator +
+		to_string(record.time) + "\n";
+	    ++records;
+	    ++unsynced;
+	    popped = true;
+	}
+
+	write_pending();
+
+	if (unsynced >= sync_records || stop ||
+	    (unsynced > 0 && chrono::steady_clock::now() - last_sync >= sync_interval))
+	    sync();
+
+	if (stop)
+	    break;
+
+	if (records >= fold_records && pending.empty())
+	    fold();
+
+	if (!popped)
+	{
+	    unique_lock<mutex> lock{wake_mutex};
+	    wake.wait_for(lock, poll_interval, [this]() { return bool{stopping}; });
+	}
+    }
+
+    if (!pending.empty())
+	report("Scores not saved to " + journal);
+}
+
+/*
+ * FUNCTION open_journal()
+ *
+ * Opens the journal for appending, creating it if needed.
+ */
+
+bool Score_Journal::open_journal()
+{
+    descriptor = open(journal.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    last_sync = chrono::steady_clock::now();
+
+    return descriptor >= 0;
+}
+
+/*
+ * FUNCTION lock_journal()
+ *
+ * Takes a shared lock of the journal, that other games also take to
+ * write, and a game folding takes alone to rename it. If the journal
+ * was renamed by another game, the new one is opened and locked.
+ */
+
+bool Score_Journal::lock_journal()
+{
+    while (true)
+    {
+	struct stat opened{};
+	struct stat named{};
+
+	if (flock(descriptor, LOCK_SH) != 0)
+	    return false;
+
+	if (fstat(descriptor, &opened) == 0 && stat(journal.c_str(), &named) == 0 &&
+	    opened.st_ino == named.st_ino && opened.st_dev == named.st_dev)
+	    return true;
+
+	// The new journal was started by the game that folded
+	fsync(descriptor);
+	close(descriptor);
+	records = 0;
+	if (!open_journal())
+	    return false;
+    }
+}
+
+/*
+ * FUNCTION write_pending()
+ *
+ * Writes the lines not yet written to the journal. What could not
+ * be written is tried again the next time.
+ */
+
+void Score_Journal::write_pending()
+{
+    if (pending.empty())
+	return;
+
+    if (!lock_journal())
+    {
+	report("Could not lock " + journal);
+	return;
+    }
+
+    while (!pending.empty())
+    {
+	ssize_t written{write(descriptor, pending.data(), pending.size())};
+
+	if (written < 0 && errno == EINTR)
+	    continue;
+
+	if (written <= 0)
+	{
+	    flock(descriptor, LOCK_UN);
+	    report("Could not write to " + journal);
+	    return;
+	}
+
+	pending.erase(0, written);
+    }
+
+    flock(descriptor, LOCK_UN);
+    failed = false;
+}
+
+/*
+ * FUNCTION sync()
+ *
+ * Makes sure that the lines written are on the disk.
+ */
+
+void Score_Journal::sync()
+{
+    if (unsynced > 0 && pending.empty())
+    {
+	fsync(descriptor);
+	unsynced = 0;
+    }
+
+    last_sync = chrono::steady_clock::now();
+}
+
+/*
+ * FUNCTION fold()
+ *
+ * Starts a new journal and writes a new snapshot with the best
+ * scores of the old one applied, and the recent scores with those of
+ * the old one that are recent, then removes the old journal. An old
+ * journal left by a crash is folded before a new one is started. A
+ * snapshot that can not be read is left as it is, with the old
+ * journal.
+ *
+ * Only one game folds at a time, the one holding the lock file. The
+ * others go on appending, and try again later. The journal is only
+ * renamed while no game writes to it.
+ */
+
+void Score_Journal::fold()
+{
+    fold_requested = false;
+
+    if (lock_descriptor < 0)
+	lock_descriptor = open(lock_file.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (lock_descriptor < 0 || flock(lock_descriptor, LOCK_EX | LOCK_NB) != 0)
+	return;
+
+    if (!ifstream{old_journal})
+    {
+	sync();
+
+	bool renamed{flock(descriptor, LOCK_EX) == 0 &&
+		     rename(journal.c_str(), old_journal.c_str()) == 0};
+	close(descriptor);
+
+	if (!open_journal())
+	{
+	    flock(lock_descriptor, LOCK_UN);
+	    report("Could not open " + journal);
+	    return;
+	}
+
+	if (!renamed)
+	{
+	    flock(lock_descriptor, LOCK_UN);
+	    report("Could not rename " + journal);
+	    return;
+	}
+
+	records = 0;
+    }
+
+    Score_File::Changes changes{};
+    read_scores(old_journal, [&changes](string const & alias, int score, time_t)
+		{
+		    auto found = changes.find(alias);
+
+		    if (found == end(changes))
+			changes.emplace(alias, score);
+		    else
+			found -> second = max(found -> second, score);
+		});
+
+    try
+    {
+	Score_File old{snapshot};
+
+	// Only scores better than the saved ones change the snapshot
+	for (auto change = begin(changes); change != end(changes); )
+	{
+	    size_t index{old.find(change -> first)};
+
+	    if (index < old.size() && old.score(index) >= change -> second)
+		change = changes.erase(change);
+	    else
+		++change;
+	}
+
+	if (keep_recent() && Score_File::write(snapshot, old, changes))
+	    remove(old_journal.c_str());
+    }
+    catch (invalid_argument const & error)
+    {
+	report(error.what());
+    }
+
+    flock(lock_descriptor, LOCK_UN);
+}
+
+/*
+ * FUNCTION keep_recent()
+ *
+ * Writes the recent scores and those of the old journal that were
+ * made in the last keep seconds as the new recent scores, and
+ * returns false if they could not be written.
+ */
+
+bool Score_Journal::keep_recent()
+{
+    time_t cutoff{time(nullptr) - keep};
+    string lines{};
+
+    auto add = [&lines, cutoff](string const & alias, int score, time_t time)
+	{
+	    if (time > cutoff)
+		lines += alias + ":" + to_string(score) + time_separator +
+		    to_string(time) + "\n";
+	};
+
+    read_scores(recent, add);
+    read_scores(old_journal, add);
+
+    // Each process writes its own, when several fold at once
+    string temporary{recent + ".tmp." + to_string(getpid())};
+    FILE * out{fopen(temporary.c_str(), "wb")};
+    if (!out)
+	return false;
+
+    fwrite(lines.data(), 1, lines.size(), out);
+
+    bool written{fflush(out) == 0 && !ferror(out) && fsync(fileno(out)) == 0};
+    fclose(out);
+
+    if (!written || rename(temporary.c_str(), recent.c_str()) != 0)
+    {
+	remove(temporary.c_str());
+	report("Could not write " + recent);
+	return false;
+    }
+
+    return true;
+}
+
+/*
+ * FUNCTION report(string const &)
+ *
+ * Prints an error of the journal thread, once until it has
+ * written to the journal again.
+ */
+
+void Score_Journal::report(string const & error)
+{
+    if (!failed)
+	cerr << error << (error.back() == '!' ? "" : "!") << endl;
+
+    failed = true;
+}
@@ -0,0 +1,162 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Journal.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Journal class which saves the scores
+ * of the Top_List as they come, and folds them into the top list
+ * file now and then.
+ */
+
+#ifndef SCORE_JOURNAL_H
+#define SCORE_JOURNAL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+
+/* CLASS Score_Journal
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Every score is appended as an "alias:score" line, followed by a
+ * tab and the time it was made, to FILE.journal, so that saving a
+ * score costs the same whatever the size of the list and nothing is
+ * lost if the game is killed. The journal is synced to disk every
+ * sync_records scores or once a second.
+ *
+ * The files are only touched by a thread of its own. append puts
+ * the score in a ring of queue_capacity records that the game
+ * thread writes and the journal thread reads, through an atomic
+ * index each, so append never takes a lock or waits for the disk.
+ * Only if the ring is full, which takes a thousand scores while a
+ * fold runs, does append wait for a free record. The destructor
+ * writes what is left in the ring and syncs the journal before it
+ * returns.
+ *
+ * When the journal has grown long it is renamed to FILE.journal.old
+ * and a new one is started, and the journal thread folds the old
+ * journal into FILE, the snapshot: a new Score_File is written that
+ * then replaces it, and the old journal is removed last. A snapshot
+ * only has the best score of every alias, so the scores of the last
+ * keep seconds are also moved to FILE.recent, for the lists of the
+ * last day or week. A score only ever raises the best score of its
+ * alias, so a crash at any point only means that some lines are read
+ * twice.
+ *
+ * The constructor reads the recent scores, an old journal left by a
+ * crash, then the journal, while the snapshot is mapped by the
+ * caller. A line without a time, of an older version, has time 0.
+ * A last line without a newline was cut off by a crash and is
+ * skipped, and cut from the journal.
+ *
+ * Several games may save to the same file. Each appends whole lines
+ * under a shared flock of the journal, one folds at a time under the
+ * flock of FILE.lock, and the journal is renamed under an exclusive
+ * flock, after which the others open the new one.
+ *
+ * CONSTRUCTORS
+ * Score_Journal(string const &, Apply const &, time_t), the snapshot
+ *     file, a function called with the alias, score and time of every
+ *     score in the journals, oldest first, and the seconds the
+ *     recent scores are kept
+ *
+ * OPERATIONS
+ * append, input string const &, int, time_t, output none
+ * read_scores, input string const &, function<...>, output off_t
+ *     (static), calls the function for every line of a file and
+ *     returns the length of the whole lines
+ *
+ * DATA MEMBERS
+ * string snapshot
+ * string journal
+ * string old_journal
+ * string lock_file, locked while folding
+ * string recent, the scores of the last keep seconds
+ * time_t keep
+ * array<Record, queue_capacity> queue
+ * atomic<size_t> queue_head, the next record to read
+ * atomic<size_t> queue_tail, the next record to write
+ * int descriptor, of the journal
+ * int lock_descriptor, of the lock file, opened at the first fold
+ * string pending, lines not yet written
+ * size_t records, lines in the journal
+ * size_t unsynced, lines not yet synced to disk
+ * time_point last_sync
+ * bool fold_requested, fold when the thread starts
+ * bool failed, true after an error was reported
+ * atomic<bool> stopping
+ * mutex wake_mutex, only taken to wake the thread when stopping
+ * condition_variable wake
+ * thread writer
+ */
+
+class Score_Journal
+{
+public:
+    using Apply = std::function<void(std::string const &, int, std::time_t)>;
+
+    static std::size_t const queue_capacity{1024};
+
+    Score_Journal(std::string const &, Apply const &, std::time_t);
+    ~Score_Journal();
+    Score_Journal(Score_Journal const &) = delete;
+    Score_Journal & operator=(Score_Journal const &) = delete;
+    void append(std::string const &, int, std::time_t);
+    static off_t read_scores(std::string const &, Apply const &);
+private:
+    struct Record
+    {
+	std::string alias;
+	int score;
+	std::time_t time;
+    };
+
+    bool pop(Record &);
+    void run();
+    bool open_journal();
+    bool lock_journal();
+    void write_pending();
+    void sync();
+    void fold();
+    bool keep_recent();
+    void report(std::string const &);
+
+    std::string snapshot{};
+    std::string journal{};
+    std::string old_journal{};
+    std::string lock_file{};
+    std::string recent{};
+    std::time_t keep{};
+    std::array<Record, queue_capacity> queue{};
+    std::atomic<std::size_t> queue_head{0};
+    std::atomic<std::size_t> queue_tail{0};
+    int descriptor{-1};
+    int lock_descriptor{-1};
+    std::string pending{};
+    std::size_t records{};
+    std::size_t unsynced{};
+    std::chrono::steady_clock::time_point last_sync{};
+    bool fold_requested{false};
+    bool failed{false};
+    std::atomic<bool> stopping{false};
+    std::mutex wake_mutex{};
+    std::condition_variable wake{};
+    std::thread writer{};
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Protocol.cpp
+ * Type:       Definitions for module Score_Protocol
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Protocol class, the messages between
+ * the leaderboard server and the games.
+ */
+
+#include "Score_Protocol.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+/*
+ * FUNCTION add_message(string &, Type, string const &)
+ *
+ * Adds the header and the body of a message to a buffer.
+ */
+
+void Score_Protocol::add_message(string & buffer, Type type, string const & body)
+{
+    if (body.size() > body_limit)
+	throw invalid_argument("Message longer than the limit!");
+
+    buffer += char(type);
+    add_u32(buffer, body.size());
+    buffer += body;
+}
+
+/*
+ * FUNCTION add_u16(string &, uint16_t)
+ *
+ * Adds a number as two bytes, least significant first.
+ */
+
+void Score_Protocol::add_u16(string & buffer, uint16_t value)
+{
+    buffer += char(value & 0xff);
+    buffer += char(value >> 8);
+}
+
+/*
+ * FUNCTION add_u32(string &, uint32_t)
+ *
+ * Adds a number as four bytes, least significant first.
+ */
+
+void Score_Protocol::add_u32(string & buffer, uint32_t value)
+{
+    for (int shift{}; shift < 32; shift += 8)
+	buffer += char((value >> shift) & 0xff);
+}
+
+/*
+ * FUNCTION add_u64(string &, uint64_t)
+ *
+ * Adds a number as eight bytes, least significant first.
+ */
+
+void Score_Protocol::add_u64(string & buffer, uint64_t value)
+{
+    add_u32(buffer, uint32_t(value));
+    add_u32(buffer, uint32_t(value >> 32));
+}
+
+/*
+ * FUNCTION add_row(string &, string const &, int)
+ *
+ * Adds an alias and a score. The alias is cut to 255 bytes.
+ */
+
+void Score_Protocol::add_row(string & buffer, string const & alias, int score)
+{
+    size_t length{min<size_t>(alias.size(), 255)};
+
+    buffer += char(length);
+    buffer.append(alias, 0, length);
+    add_u32(buffer, uint32_t(score));
+}
+
+/*
+ * FUNCTION take_message(string &, Type &, string &)
+ *
+ * If the buffer starts with a whole message, moves its type and body
+ * out of it and returns true. Throws if the body is too long.
+ */
+
+bool Score_Protocol::take_message(string & buffer, Type & type, string & body)
+{
+    if (buffer.size() < header_size)
+	return false;
+
+    size_t offset{1};
+    uint32_t length{read_u32(buffer, offset)};
+
+    if (length > body_limit)
+	throw invalid_argument("Message longer than the limit!");
+
+    if (buffer.size() < header_size + length)
+	return false;
+
+    type = Type(buffer.front());
+    body.assign(buffer, header_size, length);
+    buffer.erase(0, header_size + length);
+    return true;
+}
+
+/*
+ * FUNCTION read_u16(string const &, size_t &)
+ *
+ * Reads two bytes at the offset and moves it past them.
+ */
+
+uint16_t Score_Protocol::read_u16(string const & buffer, size_t & offset)
+{
+    if (offset + 2 > buffer.size())
+	throw invalid_argument("Message cut off!");
+
+    uint16_t value = uint8_t(buffer[offset]) | uint8_t(buffer[offset + 1]) << 8;
+    offset += 2;
+    return value;
+}
+
+/*
+ * FUNCTION read_u32(string const &, size_t &)
+ *
+ * Reads four bytes at the offset and moves it past them.
+ */
+
+uint32_t Score_Protocol::read_u32(string const & buffer, size_t & offset)
+{
+    if (offset + 4 > buffer.size())
+	throw invalid_argument("Message cut off!");
+
+    uint32_t value{};
+    for (int byte{}; byte < 4; ++byte)
+	value |= uint32_t(uint8_t(buffer[offset + byte])) << (8 * byte);
+
+    offset += 4;
+    return value;
+}
+
+/*
+ * FUNCTION read_u64(string const &, size_t &)
+ *
+ * Reads eight bytes at the offset and moves it past them.
+ */
+
+uint64_t Score_Protocol::read_u64(string const & buffer, size_t & offset)
+{
+    uint64_t low{read_u32(buffer, offset)};
+    return low | uint64_t(read_u32(buffer, offset)) << 32;
+}
+
+/*
+ * FUNCTION read_rows(string const &, size_t)
+ *
+ * Reads the rows from the offset to the end of a body.
+ */
+
+Score_Protocol::Rows Score_Protocol::read_rows(string const & body, size_t offset)
+{
+    Rows rows{};
+
+    while (offset < body.size())
+    {
+	size_t length{uint8_t(body[offset])};
+	if (offset + 1 + length > body.size())
+	    throw invalid_argument("Message cut off!");
+
+	string alias{body, offset + 1, length};
+	offset += 1 + length;
+	rows.emplace_back(move(alias), int32_t(read_u32(body, offset)));
+    }
+
+    return rows;
+}
@@ -0,0 +1,94 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Protocol.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Protocol class, the messages between
+ * the leaderboard server and the games.
+ */
+
+#ifndef SCORE_PROTOCOL_H
+#define SCORE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* CLASS Score_Protocol
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Builds and reads the messages of the leaderboard server. Every
+ * message is a type byte, the length of the body as four bytes and
+ * the body. Numbers are little endian and a row is the length of
+ * the alias as one byte, the alias and the score as four bytes, so
+ * a score takes about 15 bytes on the wire.
+ *
+ *     SUBMIT  game to server, the id of the game as eight bytes, the
+ *             number of the batch as four bytes and rows of new
+ *             scores
+ *     TOP     game to server, the number of rows wanted, two bytes
+ *     ACK     server to game, the number of scores saved, four bytes
+ *     ROWS    server to game, the size of the list, four bytes, and
+ *             the best rows
+ *
+ * Aliases longer than 255 bytes are cut, and a body longer than
+ * body_limit is an error, so a broken peer can not make the other
+ * side buffer without end.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * add_message, input string &, Type, string const &, output none,
+ *     adds a message with the body to a buffer
+ * add_u16, input string &, uint16_t, output none
+ * add_u32, input string &, uint32_t, output none
+ * add_u64, input string &, uint64_t, output none
+ * add_row, input string &, string const &, int, output none
+ * take_message, input string &, Type &, string &, output bool, moves
+ *     the first whole message of a buffer to the type and body,
+ *     false if there is none yet
+ * read_u16, input string const &, size_t &, output uint16_t
+ * read_u32, input string const &, size_t &, output uint32_t
+ * read_u64, input string const &, size_t &, output uint64_t
+ * read_rows, input string const &, size_t, output Rows, the rows
+ *     of a body from an offset
+ *
+ * DATA MEMBERS
+ * None
+ */
+
+class Score_Protocol
+{
+public:
+    using Rows = std::vector<std::pair<std::string, int>>;
+
+    enum Type : std::uint8_t { SUBMIT = 'S', TOP = 'T', ACK = 'A', ROWS = 'R' };
+
+    static std::size_t const header_size{5};
+    static std::size_t const body_limit{1 << 20};
+
+    Score_Protocol() = delete;
+    static void add_message(std::string &, Type, std::string const &);
+    static void add_u16(std::string &, std::uint16_t);
+    static void add_u32(std::string &, std::uint32_t);
+    static void add_u64(std::string &, std::uint64_t);
+    static void add_row(std::string &, std::string const &, int);
+    static bool take_message(std::string &, Type &, std::string &);
+    static std::uint16_t read_u16(std::string const &, std::size_t &);
+    static std::uint32_t read_u32(std::string const &, std::size_t &);
+    static std::uint64_t read_u64(std::string const &, std::size_t &);
+    static Rows read_rows(std::string const &, std::size_t);
+};
+
+#endif
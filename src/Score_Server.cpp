@@ -0,0 +1,256 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Server.cpp
+ * Type:       Definitions for module Score_Server
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Server class, the leaderboard server
+ * that keeps one top list for many games.
+ */
+
+#include "Score_Server.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#define receive_size 65536
+#define output_limit (1 << 20)
+#define idle_wait sf::milliseconds(200)
+#define send_wait sf::milliseconds(5)
+#define game_lifetime chrono::hours(1)
+#define sweep_interval chrono::minutes(1)
+
+using namespace std;
+
+/*
+ * FUNCTION Score_Server(string const &, unsigned short, IpAddress const &)
+ *
+ * Constructor for Score_Server. Loads the top list and listens on
+ * the address, 0.0.0.0 for every network of the machine.
+ */
+
+Score_Server::Score_Server(string const & file, unsigned short port,
+			   sf::IpAddress const & address) :
+    toplist{file}
+{
+    if (listener.listen(port, address) != sf::Socket::Done)
+	throw invalid_argument("Could not serve scores on " + address.toString() +
+			       " port " + to_string(port) + "!");
+
+    selector.add(listener);
+}
+
+/*
+ * FUNCTION run(sig_atomic_t const &)
+ *
+ * Serves the games until the flag is set. Waits a short while at a
+ * time so that it notices the flag, and only a few milliseconds while
+ * some answers have not been taken by their socket yet.
+ */
+
+void Score_Server::run(volatile sig_atomic_t const & stop)
+{
+    while (!stop)
+    {
+	bool sending{any_of(begin(clients), end(clients),
+			    [](Client const & client) { return !client.output.empty(); })};
+	bool ready{selector.wait(sending ? send_wait : idle_wait)};
+
+	if (ready && selector.isReady(listener))
+	    accept();
+
+	for (size_t index{}; index < clients.size();)
+	{
+	    Client & client{clients.at(index)};
+
+	    if ((!ready || !selector.isReady(*client.socket) || receive(client)) &&
+		send(client))
+	    {
+		++index;
+		continue;
+	    }
+
+	    selector.remove(*client.socket);
+	    clients.erase(begin(clients) + index);
+	}
+
+	forget_games();
+    }
+}
+
+/*
+ * FUNCTION get_port()
+ *
+ * Returns the port the server listens on.
+ */
+
+unsigned short Score_Server::get_port() const
+{
+    return listener.getLocalPort();
+}
+
+/*
+ * FUNCTION get_submissions()
+ *
+ * Returns the number of scores saved since the server started.
+ */
+
+uint64_t Score_Server::get_submissions() const
+{
+    return submissions;
+}
+
+/*
+ * FUNCTION accept()
+ *
+ * Adds a game that connects.
+ */
+
+void Score_Server::accept()
+{
+    Client client{make_unique<sf::TcpSocket>(), string{}, string{}};
+
+    if (listener.accept(*client.socket) != sf::Socket::Done)
+	return;
+
+    client.socket -> setBlocking(false);
+    selector.add(*client.socket);
+    clients.push_back(move(client));
+}
+
+/*
+ * FUNCTION receive(Client &)
+ *
+ * Reads what a game has sent and adds the answer to every whole
+ * message in it to the output of the game. Returns false if the game
+ * disconnected, sent a broken message or has too much output waiting.
+ */
+
+bool Score_Server::receive(Client & client)
+{
+    char buffer[receive_size];
+    size_t received{};
+    sf::Socket::Status status{client.socket -> receive(buffer, receive_size, received)};
+
+    if (status == sf::Socket::NotReady)
+	return true;
+    if (status != sf::Socket::Done)
+	return false;
+
+    client.input.append(buffer, received);
+
+    Score_Protocol::Type type{};
+    string body{};
+
+    try
+    {
+	while (Score_Protocol::take_message(client.input, type, body))
+	    answer(type, body, client.output);
+    }
+    catch (invalid_argument const &)
+    {
+	return false;
+    }
+
+    return client.output.size() <= output_limit;
+}
+
+/*
+ * FUNCTION send(Client &)
+ *
+ * Sends as much of the output of a game as its socket takes now, and
+ * keeps the rest for later. Returns false if the game disconnected.
+ */
+
+bool Score_Server::send(Client & client)
+{
+    if (client.output.empty())
+	return true;
+
+    size_t sent{};
+    sf::Socket::Status status{client.socket -> send(client.output.data(),
+						    client.output.size(), sent)};
+    client.output.erase(0, sent);
+
+    return status == sf::Socket::Done || status == sf::Socket::Partial ||
+	status == sf::Socket::NotReady;
+}
+
+/*
+ * FUNCTION forget_games()
+ *
+ * Once a minute, forgets the batch numbers of the games not heard
+ * from in game_lifetime. Such a game has long given up a batch, and
+ * the numbers of every game ever seen would otherwise fill memory.
+ */
+
+void Score_Server::forget_games()
+{
+    auto now = chrono::steady_clock::now();
+    if (now - swept < sweep_interval)
+	return;
+
+    swept = now;
+    for (auto batch = begin(batches); batch != end(batches);)
+    {
+	if (now - batch -> second.heard > game_lifetime)
+	    batch = batches.erase(batch);
+	else
+	    ++batch;
+    }
+}
+
+/*
+ * FUNCTION answer(Type, string const &, string &)
+ *
+ * Handles a message and adds the answer to the output. A submission
+ * is answered with the number of scores in it, and only saved if the
+ * game has not sent its batch before. A request for the best rows is
+ * answered with the size of the list and the rows.
+ */
+
+void Score_Server::answer(Score_Protocol::Type type, string const & body, string & output)
+{
+    string reply{};
+
+    if (type == Score_Protocol::SUBMIT)
+    {
+	size_t offset{};
+	uint64_t game{Score_Protocol::read_u64(body, offset)};
+	uint32_t batch{Score_Protocol::read_u32(body, offset)};
+	Score_Protocol::Rows rows{Score_Protocol::read_rows(body, offset)};
+
+	// A batch sent again after a lost answer is not saved twice
+	Batch & seen{batches[game]};
+	seen.heard = chrono::steady_clock::now();
+	if (batch > seen.last)
+	{
+	    for (auto && row : rows)
+	    {
+		toplist.insert(row.first, row.second);
+		toplist.record_game(row.second);
+	    }
+	    submissions += rows.size();
+	    seen.last = batch;
+	}
+
+	Score_Protocol::add_u32(reply, rows.size());
+	Score_Protocol::add_message(output, Score_Protocol::ACK, reply);
+    }
+    else if (type == Score_Protocol::TOP)
+    {
+	size_t offset{};
+	unsigned wanted{Score_Protocol::read_u16(body, offset)};
+
+	Score_Protocol::add_u32(reply, toplist.size());
+	for (auto && row : toplist.get(wanted))
+	    Score_Protocol::add_row(reply, row.first, row.second);
+
+	Score_Protocol::add_message(output, Score_Protocol::ROWS, reply);
+    }
+    else
+	throw invalid_argument("Unknown message!");
+}
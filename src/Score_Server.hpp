@@ -0,0 +1,112 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Server.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Server class, the leaderboard server
+ * that keeps one top list for many games.
+ */
+
+#ifndef SCORE_SERVER_H
+#define SCORE_SERVER_H
+
+#include <SFML/Network.hpp>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Top_List.hpp"
+#include "Score_Protocol.hpp"
+
+/* CLASS Score_Server
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Keeps a Top_List, saved like that of a game, and answers the
+ * messages of Score_Protocol from any number of games on one thread.
+ * All sockets are in one selector and never block. A socket is only
+ * read when the selector says it is ready, and the answers are kept
+ * in an output buffer of the game until its socket takes them, so a
+ * slow game never holds up the others. The buffers are sent again
+ * every few milliseconds while any holds bytes. A game that sends a
+ * broken message, or does not read its answers until a megabyte is
+ * waiting, is disconnected.
+ *
+ * A game sends a batch again when its answer did not come in time.
+ * The last batch number of every game is remembered, so a batch the
+ * server already saved is answered but not saved twice. A game that
+ * has sent nothing for an hour is forgotten, and the numbers are only
+ * kept while the server runs.
+ *
+ * CONSTRUCTORS
+ * Score_Server(string const &, unsigned short, IpAddress const &), the
+ *     top list file, the port, 0 picks a free one, and the address
+ *     to listen on, localhost if not given
+ *
+ * OPERATIONS
+ * run, input sig_atomic_t const &, output none, serves until the
+ *     flag is set
+ * get_port, input none, output unsigned short
+ * get_submissions, input none, output uint64_t, scores saved so far
+ *
+ * DATA MEMBERS
+ * Top_List toplist
+ * TcpListener listener
+ * SocketSelector selector
+ * vector<Client> clients
+ * map<uint64_t, Batch> batches, the last batch saved of every game and
+ *     when the game was last heard
+ * time_point swept, when old games were last forgotten
+ * uint64_t submissions
+ */
+
+class Score_Server
+{
+public:
+    Score_Server(std::string const &, unsigned short,
+		 sf::IpAddress const & = sf::IpAddress::LocalHost);
+    Score_Server(Score_Server const &) = delete;
+    Score_Server & operator=(Score_Server const &) = delete;
+    void run(volatile std::sig_atomic_t const &);
+    unsigned short get_port() const;
+    std::uint64_t get_submissions() const;
+private:
+    struct Client
+    {
+	std::unique_ptr<sf::TcpSocket> socket;
+	std::string input;
+	std::string output;
+    };
+
+    struct Batch
+    {
+	std::uint32_t last{};
+	std::chrono::steady_clock::time_point heard{};
+    };
+
+    void accept();
+    bool receive(Client &);
+    bool send(Client &);
+    void forget_games();
+    void answer(Score_Protocol::Type, std::string const &, std::string &);
+
+    Top_List toplist;
+    sf::TcpListener listener{};
+    sf::SocketSelector selector{};
+    std::vector<Client> clients{};
+    std::map<std::uint64_t, Batch> batches{};
+    std::chrono::steady_clock::time_point swept{std::chrono::steady_clock::now()};
+    std::uint64_t submissions{};
+};
+
+#endif
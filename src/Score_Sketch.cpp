@@ -0,0 +1,419 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Sketch.cpp
+ * Type:       Definitions for module Score_Sketch
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Sketch class, the distribution of the
+ * scores of every game played.
+ */
+
+#include "Score_Sketch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#define sketch_magic "PSIS"
+#define sketch_version 1
+#define shrink_factor (2.0 / 3.0)
+#define level_limit 64
+
+using namespace std;
+
+/*
+ * FUNCTION add(int)
+ *
+ * Adds the score of a game.
+ */
+
+void Score_Sketch::add(int score)
+{
+    if (levels.empty())
+	levels.emplace_back();
+
+    levels.front().push_back(score);
+    ++held;
+
+    int bin{score < 0 ? 0 : score / bin_width};
+    ++bins[min<size_t>(bin, bin_count - 1)];
+    ++games;
+    sum += score;
+    summary_stale = true;
+
+    compress();
+}
+
+/*
+ * FUNCTION merge(Score_Sketch const &)
+ *
+ * Adds the games of another sketch, compacting the scores as needed.
+ */
+
+void Score_Sketch::merge(Score_Sketch const & other)
+{
+    if (levels.size() < other.levels.size())
+	levels.resize(other.levels.size());
+
+    for (size_t level{}; level < other.levels.size(); ++level)
+	levels[level].insert(end(levels[level]), begin(other.levels[level]),
+			     end(other.levels[level]));
+
+    held += other.held;
+
+    for (size_t bin{}; bin < bin_count; ++bin)
+	bins[bin] += other.bins[bin];
+
+    games += other.games;
+    sum += other.sum;
+    summary_stale = true;
+
+    compress();
+}
+
+/*
+ * FUNCTION count()
+ *
+ * Returns the number of games added.
+ */
+
+uint64_t Score_Sketch::count() const
+{
+    return games;
+}
+
+/*
+ * FUNCTION fraction_below(int)
+ *
+ * Returns the share of the games with a score lower than one, from
+ * 0 to 1.
+ */
+
+double Score_Sketch::fraction_below(int score) const
+{
+    if (games == 0)
+	return 0;
+
+    summarize();
+
+    auto found = lower_bound(begin(summary), end(summary), score,
+			     [](pair<int, uint64_t> const & item, int value)
+			     {
+				 return item.first < value;
+			     });
+
+    if (found == begin(summary))
+	return 0;
+
+    return double(prev(found) -> second) / games;
+}
+
+/*
+ * FUNCTION quantile(double)
+ *
+ * Returns the lowest score that a share of the games, from 0 to 1,
+ * are at or below.
+ */
+
+int Score_Sketch::quantile(double share) const
+{
+    if (games == 0)
+	return 0;
+
+    summarize();
+
+    uint64_t wanted = max<uint64_t>(1, ceil(clamp(share, 0.0, 1.0) * games));
+
+    auto found = lower_bound(begin(summary), end(summary), wanted,
+			     [](pair<int, uint64_t> const & item, uint64_t value)
+			     {
+				 return item.second < value;
+			     });
+
+    return found == end(summary) ? summary.back().first : found -> first;
+}
+
+/*
+ * FUNCTION get_bins()
+ *
+ * Returns the number of games in every bin of the histogram.
+ */
+
+Score_Sketch::Bins const & Score_Sketch::get_bins() const
+{
+    return bins;
+}
+
+/*
+ * FUNCTION get_sum()
+ *
+ * Returns the sum of the scores of all games.
+ */
+
+double Score_Sketch::get_sum() const
+{
+    return sum;
+}
+
+/*
+ * FUNCTION write(ostream &)
+ *
+ * Writes the sketch as text: a header, the number of games, sum and
+ * compactions, the bins, and every compactor as its size and scores.
+ */
+
+void Score_Sketch::write(ostream & out) const
+{
+    streamsize precision{out.precision(17)};
+
+    out << sketch_magic << " " << sketch_version << "\n"
+	<< games << " " << sum << " " << compactions << "\n";
+
+    for (auto && bin : bins)
+	out << bin << " ";
+    out << "\n" << levels.size() << "\n";
+
+    for (auto && level : levels)
+    {
+	out << level.size();
+	for (auto && score : level)
+	    out << " " << score;
+	out << "\n";
+    }
+
+    out.precision(precision);
+}
+
+/*
+ * FUNCTION read(istream &)
+ *
+ * Reads a sketch written by write. The scores of the compactors must
+ * stand for as many games as were added.
+ */
+
+Score_Sketch Score_Sketch::read(istream & in)
+{
+    Score_Sketch sketch{};
+    string magic{};
+    int version{};
+    size_t level_count{};
+
+    if (!(in >> magic >> version) || magic != sketch_magic || version != sketch_version)
+	throw invalid_argument("Not a score sketch!");
+
+    in >> sketch.games >> sketch.sum >> sketch.compactions;
+
+    uint64_t binned{};
+    for (auto && bin : sketch.bins)
+    {
+	in >> bin;
+	binned += bin;
+    }
+
+    if (!(in >> level_count) || level_count > level_limit)
+	throw invalid_argument("Damaged score sketch!");
+
+    uint64_t weight{};
+    sketch.levels.resize(level_count);
+
+    for (size_t level{}; level < level_count; ++level)
+    {
+	size_t size{};
+	if (!(in >> size) || size > 4 * accuracy)
+	    throw invalid_argument("Damaged score sketch!");
+
+	sketch.levels[level].resize(size);
+	for (auto && score : sketch.levels[level])
+	    in >> score;
+
+	sketch.held += size;
+	weight += uint64_t(size) << level;
+    }
+
+    if (!in || binned != sketch.games || weight != sketch.games)
+	throw invalid_argument("Damaged score sketch!");
+
+    sketch.summary_stale = true;
+    return sketch;
+}
+
+/*
+ * FUNCTION load(string const &)
+ *
+ * Reads a sketch from a file, or returns an empty one if there is
+ * no file.
+ */
+
+Score_Sketch Score_Sketch::load(string const & file)
+{
+    ifstream in{file};
+
+    if (!in)
+	return Score_Sketch{};
+
+    return read(in);
+}
+
+/*
+ * FUNCTION update(string const &, Score_Sketch const &)
+ *
+ * Merges a sketch into the one of a file, and writes it back with a
+ * rename. FILE.lock is held meanwhile, so that no game adds its
+ * games in between. Returns false if the file could not be read or
+ * written.
+ */
+
+bool Score_Sketch::update(string const & file, Score_Sketch const & added)
+{
+    string lock_file{file + ".lock"};
+    int lock{open(lock_file.c_str(), O_RDWR | O_CREAT, 0644)};
+
+    if (lock < 0 || flock(lock, LOCK_EX) != 0)
+    {
+	if (lock >= 0)
+	    close(lock);
+	return false;
+    }
+
+    bool written{false};
+
+    try
+    {
+	Score_Sketch sketch{load(file)};
+	sketch.merge(added);
+
+	ostringstream text{};
+	sketch.write(text);
+
+	// Each process writes its own, like the top list file
+	string temporary{file + ".tmp." + to_string(getpid())};
+	FILE * out{fopen(temporary.c_str(), "wb")};
+
+	if (out)
+	{
+	    string const & bytes{text.str()};
+	    fwrite(bytes.data(), 1, bytes.size(), out);
+
+	    written = fflush(out) == 0 && !ferror(out) && fsync(fileno(out)) == 0;
+	    fclose(out);
+
+	    if (!written || rename(temporary.c_str(), file.c_str()) != 0)
+	    {
+		remove(temporary.c_str());
+		written = false;
+	    }
+	}
+    }
+    catch (invalid_argument const &)
+    {
+    }
+
+    flock(lock, LOCK_UN);
+    close(lock);
+    return written;
+}
+
+/*
+ * FUNCTION capacity(size_t)
+ *
+ * Returns the number of scores a compactor holds before it is
+ * compacted, accuracy for the top one and two thirds of that for
+ * every one below, but at least two.
+ */
+
+size_t Score_Sketch::capacity(size_t level) const
+{
+    double shrink{pow(shrink_factor, double(levels.size() - 1 - level))};
+    return max<size_t>(2, ceil(accuracy * shrink));
+}
+
+/*
+ * FUNCTION compress()
+ *
+ * Compacts the lowest full compactor until the sketch holds no more
+ * scores than the compactors together. A compactor that is
+ * compacted keeps its highest score if it holds an odd number, so
+ * that the games stood for stay the same.
+ */
+
+void Score_Sketch::compress()
+{
+    while (true)
+    {
+	size_t total{};
+	for (size_t level{}; level < levels.size(); ++level)
+	    total += capacity(level);
+
+	if (held < total)
+	    return;
+
+	for (size_t level{}; level < levels.size(); ++level)
+	{
+	    if (levels[level].size() < capacity(level))
+		continue;
+
+	    if (level + 1 == levels.size())
+		levels.emplace_back();
+
+	    vector<int> & scores{levels[level]};
+	    sort(begin(scores), end(scores));
+
+	    size_t paired{scores.size() - scores.size() % 2};
+	    size_t offset{compactions++ % 2};
+
+	    for (size_t index{offset}; index < paired; index += 2)
+		levels[level + 1].push_back(scores[index]);
+
+	    scores.erase(begin(scores), begin(scores) + paired);
+	    held -= paired / 2;
+	    break;
+	}
+    }
+}
+
+/*
+ * FUNCTION summarize()
+ *
+ * Makes the sorted scores and the games at or below each, if the
+ * sketch changed since it was last done. A score in compactor h
+ * stands for 2^h games.
+ */
+
+void Score_Sketch::summarize() const
+{
+    if (!summary_stale)
+	return;
+
+    vector<pair<int, uint64_t>> weighted{};
+    weighted.reserve(held);
+
+    for (size_t level{}; level < levels.size(); ++level)
+	for (auto && score : levels[level])
+	    weighted.emplace_back(score, uint64_t(1) << level);
+
+    sort(begin(weighted), end(weighted));
+
+    summary.clear();
+    uint64_t cumulative{};
+
+    for (auto && item : weighted)
+    {
+	cumulative += item.second;
+
+	if (!summary.empty() && summary.back().first == item.first)
+	    summary.back().second = cumulative;
+	else
+	    summary.emplace_back(item.first, cumulative);
+    }
+
+    summary_stale = false;
+}
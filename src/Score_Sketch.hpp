@@ -0,0 +1,123 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Sketch.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Sketch class, the distribution of the
+ * scores of every game played, in bounded memory.
+ */
+
+#ifndef SCORE_SKETCH_H
+#define SCORE_SKETCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* CLASS Score_Sketch
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * The scores of all games, kept as a KLL quantile sketch and a
+ * histogram of bin_count bins of bin_width points, the last of which
+ * holds every higher score. Both take the same memory whatever the
+ * number of games, and two sketches, of two machines or two
+ * sessions, are merged into one as if all games were added to it.
+ *
+ * The sketch is a stack of compactors. A score is added to the
+ * lowest, and a compactor that is full is sorted and every other
+ * score moves to the one above, where it stands for twice as many
+ * games, alternately the odd and the even ones. The capacity shrinks
+ * by two thirds from the top compactor down, so the sketch holds
+ * about 3 * accuracy scores, and a rank is off by less than one
+ * percent of the games, measured over millions of games.
+ *
+ * Queries use a sorted copy of the sketch with the number of games
+ * at or below every score, made again only after the sketch changed,
+ * so a query is a binary search.
+ *
+ * The sketch is written and read as text, in the same form on every
+ * machine. update merges a sketch into a file, under a lock, so that
+ * many games can add theirs to the same file.
+ *
+ * CONSTRUCTORS
+ * Score_Sketch(), no games
+ *
+ * OPERATIONS
+ * add, input int, output none, the score of a game
+ * merge, input Score_Sketch const &, output none
+ * count, input none, output uint64_t, the games added
+ * fraction_below, input int, output double, the share of the games
+ *     with a lower score, 0 when there are none
+ * quantile, input double, output int, the score a share of the games
+ *     are at or below
+ * get_bins, input none, output Bins const &
+ * get_sum, input none, output double, of all scores
+ * write, input ostream &, output none
+ * read, input istream &, output Score_Sketch, (static)
+ * load, input string const &, output Score_Sketch, (static) an empty
+ *     sketch if there is no file
+ * update, input string const &, Score_Sketch const &, output bool,
+ *     (static) merges a sketch into a file
+ *
+ * DATA MEMBERS
+ * vector<vector<int>> levels, the compactors, lowest first
+ * size_t held, scores in the compactors
+ * unsigned compactions, the number of compactions, that picks odd or
+ *     even scores
+ * Bins bins
+ * uint64_t games
+ * double sum
+ * vector<pair<int, uint64_t>> summary, sorted scores and the games
+ *     at or below them, made again when summary_stale
+ * bool summary_stale
+ */
+
+class Score_Sketch
+{
+public:
+    static std::size_t const accuracy{200};
+    static std::size_t const bin_count{80};
+    static int const bin_width{250};
+
+    using Bins = std::array<std::uint64_t, bin_count>;
+
+    Score_Sketch() = default;
+    void add(int);
+    void merge(Score_Sketch const &);
+    std::uint64_t count() const;
+    double fraction_below(int) const;
+    int quantile(double) const;
+    Bins const & get_bins() const;
+    double get_sum() const;
+    void write(std::ostream &) const;
+    static Score_Sketch read(std::istream &);
+    static Score_Sketch load(std::string const &);
+    static bool update(std::string const &, Score_Sketch const &);
+private:
+    std::size_t capacity(std::size_t) const;
+    void compress();
+    void summarize() const;
+
+    std::vector<std::vector<int>> levels{};
+    std::size_t held{};
+    unsigned compactions{};
+    Bins bins{};
+    std::uint64_t games{};
+    double sum{};
+    mutable std::vector<std::pair<int, std::uint64_t>> summary{};
+    mutable bool summary_stale{false};
+};
+
+#endif
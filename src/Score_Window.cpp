@@ -0,0 +1,191 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Window.cpp
+ * Type:       Definitions for module Score_Window
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Score_Window class, the best scores of a
+ * period that ends now.
+ */
+
+#include "Score_Window.hpp"
+#include <limits>
+
+using namespace std;
+
+/*
+ * FUNCTION Score_Window(time_t, size_t)
+ *
+ * Constructor for Score_Window. Nothing has expired until the first
+ * call to expire.
+ */
+
+Score_Window::Score_Window(time_t length_init, size_t watched_init) :
+    length{length_init}, watched{watched_init},
+    cutoff{numeric_limits<time_t>::min()}
+{
+}
+
+/*
+ * FUNCTION add(string const &, int, time_t)
+ *
+ * Adds a score made at a time, and makes it the best of its alias
+ * if it is better than the others in the window.
+ */
+
+void Score_Window::add(string const & alias, int score, time_t time)
+{
+    if (time <= cutoff)
+	return;
+
+    records.emplace(time, make_pair(alias, score));
+
+    auto found = scores.find(alias);
+    if (found == end(scores))
+    {
+	scores[alias].insert(score);
+	rank_in(alias, score);
+	return;
+    }
+
+    int best{*found -> second.rbegin()};
+    found -> second.insert(score);
+
+    if (score > best)
+    {
+	unrank(alias, best);
+	rank_in(alias, score);
+    }
+}
+
+/*
+ * FUNCTION expire(time_t)
+ *
+ * Removes the scores made length seconds or more before a time. An
+ * alias whose best score expired gets its next best, or leaves the
+ * window with its last score.
+ */
+
+void Score_Window::expire(time_t now)
+{
+    cutoff = max(cutoff, now - length);
+
+    while (!records.empty() && begin(records) -> first <= cutoff)
+    {
+	auto record = begin(records);
+	string const & alias{record -> second.first};
+	int score{record -> second.second};
+
+	auto found = scores.find(alias);
+	multiset<int> & kept{found -> second};
+	int best{*kept.rbegin()};
+
+	kept.erase(kept.find(score));
+
+	if (kept.empty())
+	{
+	    unrank(alias, best);
+	    scores.erase(found);
+	}
+	else if (*kept.rbegin() != best)
+	{
+	    unrank(alias, best);
+	    rank_in(alias, *kept.rbegin());
+	}
+
+	records.erase(record);
+    }
+}
+
+/*
+ * FUNCTION rank(string const &)
+ *
+ * Returns the place of an alias in the window, 1 for the best score,
+ * or 0 if the alias has no score in it.
+ */
+
+size_t Score_Window::rank(string const & alias) const
+{
+    auto found = scores.find(alias);
+
+    if (found == end(scores))
+	return 0;
+
+    return ranking.order_of_key(make_pair(*found -> second.rbegin(), alias)) + 1;
+}
+
+/*
+ * FUNCTION size()
+ *
+ * Returns the number of aliases with a score in the window.
+ */
+
+size_t Score_Window::size() const
+{
+    return ranking.size();
+}
+
+/*
+ * FUNCTION get(unsigned)
+ *
+ * Returns the list_rows best aliases and their scores, best first.
+ */
+
+vector<pair<string, int>> Score_Window::get(unsigned list_rows) const
+{
+    vector<pair<string, int>> list{};
+
+    for (auto item = begin(ranking); item != end(ranking) && list.size() < list_rows; ++item)
+	list.emplace_back(item -> second, item -> first);
+
+    return list;
+}
+
+/*
+ * FUNCTION take_changed()
+ *
+ * Returns true if the watched rows changed since the last call.
+ */
+
+bool Score_Window::take_changed()
+{
+    bool was_changed{changed};
+    changed = false;
+    return was_changed;
+}
+
+/*
+ * FUNCTION unrank(string const &, int)
+ *
+ * Takes the best score of an alias out of the ranking.
+ */
+
+void Score_Window::unrank(string const & alias, int best)
+{
+    pair<int, string> key{best, alias};
+
+    if (ranking.order_of_key(key) < watched)
+	changed = true;
+
+    ranking.erase(key);
+}
+
+/*
+ * FUNCTION rank_in(string const &, int)
+ *
+ * Puts the best score of an alias in the ranking.
+ */
+
+void Score_Window::rank_in(string const & alias, int best)
+{
+    pair<int, string> key{best, alias};
+
+    ranking.insert(key);
+
+    if (ranking.order_of_key(key) < watched)
+	changed = true;
+}
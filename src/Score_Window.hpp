@@ -0,0 +1,114 @@
+/*
+ * IDENTIFICATION
+ * File name:  Score_Window.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Score_Window class, the best scores of a
+ * period that ends now, such as the last day or week.
+ */
+
+#ifndef SCORE_WINDOW_H
+#define SCORE_WINDOW_H
+
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+/* CLASS Score_Window
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * The best score of every alias among the scores of the last length
+ * seconds. Every score is kept with its time until it expires, in
+ * time order, and in a multiset of the scores of its alias, so when
+ * a best score expires the next best of the alias takes its place.
+ * The best scores are in an order statistics tree, so the rank of an
+ * alias is found in O(log n) and the best k in O(k).
+ *
+ * add and expire only do work for the scores that come and go, so
+ * the window is kept up to date as scores arrive, and expire can be
+ * called every frame. A change that moves one of the first watched
+ * rows is remembered until take_changed, so that the rows shown are
+ * only laid out again when they change.
+ *
+ * CONSTRUCTORS
+ * Score_Window(time_t, size_t), the length in seconds and the rows
+ *     watched for changes
+ *
+ * OPERATIONS
+ * add, input string const &, int, time_t, output none, a score and
+ *     its time, ignored if it has already expired
+ * expire, input time_t, output none, removes the scores older than
+ *     length at a time
+ * rank, input string const &, output size_t, 1 for the best score,
+ *     0 for an alias without scores in the window
+ * size, input none, output size_t, the aliases in the window
+ * get, input unsigned, output the best rows as alias and score
+ * take_changed, input none, output bool, true if the watched rows
+ *     changed since the last call
+ *
+ * DATA MEMBERS
+ * time_t length
+ * size_t watched
+ * time_t cutoff, scores at or before it have expired
+ * multimap<time_t, pair<string, int>> records, the scores by time
+ * map<string, multiset<int>> scores, of every alias
+ * Ranking ranking, the best score of every alias, best first
+ * bool changed
+ */
+
+class Score_Window
+{
+public:
+    // Higher scores first, equal scores by alias
+    struct Better
+    {
+	bool operator()(std::pair<int, std::string> const & item,
+			std::pair<int, std::string> const & other) const
+	{
+	    if (item.first == other.first)
+		return item.second < other.second;
+	    return item.first > other.first;
+	}
+    };
+
+    using Ranking = __gnu_pbds::tree<std::pair<int, std::string>,
+				     __gnu_pbds::null_type, Better,
+				     __gnu_pbds::rb_tree_tag,
+				     __gnu_pbds::tree_order_statistics_node_update>;
+
+    Score_Window(std::time_t, std::size_t);
+    void add(std::string const &, int, std::time_t);
+    void expire(std::time_t);
+    std::size_t rank(std::string const &) const;
+    std::size_t size() const;
+    std::vector<std::pair<std::string, int>> get(unsigned) const;
+    bool take_changed();
+private:
+    void unrank(std::string const &, int);
+    void rank_in(std::string const &, int);
+
+    std::time_t length{};
+    std::size_t watched{};
+    std::time_t cutoff{};
+    std::multimap<std::time_t, std::pair<std::string, int>> records{};
+    std::map<std::string, std::multiset<int>, std::less<>> scores{};
+    Ranking ranking{};
+    bool changed{false};
+};
+
+#endif
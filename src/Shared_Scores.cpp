@@ -0,0 +1,430 @@
+/*
+ * IDENTIFICATION
+ * File name:  Shared_Scores.cpp
+ * Type:       Definitions for module Shared_Scores
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Shared_Scores class, a top list in shared
+ * memory for the games running on one machine.
+ */
+
+#include "Shared_Scores.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A tag and the size of the layout, change the tag whenever the layout changes
+#define segment_magic ((uint64_t(0x50534932) << 32) | sizeof(Segment))
+#define ready_timeout std::chrono::seconds(1)
+#define lock_timeout std::chrono::seconds(1)
+
+using namespace std;
+
+/*
+ * FUNCTION better(int, char const *, int, char const *)
+ *
+ * True if the first score and alias come before the second, the
+ * higher score first and equal scores by alias.
+ */
+
+static bool better(int score, char const * alias, int other_score, char const * other_alias)
+{
+    if (score == other_score)
+	return strncmp(alias, other_alias, Shared_Scores::alias_size) < 0;
+    return score > other_score;
+}
+
+/*
+ * FUNCTION same_file(int, string const &)
+ *
+ * True if the segment of a descriptor is still the one with the
+ * path, and not one another process has made in its place.
+ */
+
+static bool same_file(int descriptor, string const & path)
+{
+    int current{shm_open(path.c_str(), O_RDONLY, 0)};
+    if (current < 0)
+	return false;
+
+    struct stat ours{};
+    struct stat theirs{};
+    bool same{fstat(descriptor, &ours) == 0 && fstat(current, &theirs) == 0 &&
+	      ours.st_dev == theirs.st_dev && ours.st_ino == theirs.st_ino};
+    close(current);
+    return same;
+}
+
+/*
+ * FUNCTION Shared_Scores(string const &)
+ *
+ * Constructor for Shared_Scores. Creates and sets up the segment, or
+ * maps the one that exists and waits until it is set up. A segment
+ * that is never set up, because its creator died, or that has another
+ * layout, is removed and made again once.
+ */
+
+Shared_Scores::Shared_Scores(string const & name) :
+    process{int32_t(getpid())}
+{
+    string path{"/" + name};
+
+    if (!attach(path))
+    {
+	creator = false;
+	if (!attach(path))
+	    throw invalid_argument("Shared memory " + name + " is not a top list!");
+    }
+}
+
+/*
+ * FUNCTION ~Shared_Scores()
+ *
+ * Destructor for Shared_Scores, unmaps the segment but leaves it.
+ */
+
+Shared_Scores::~Shared_Scores()
+{
+    munmap(segment, sizeof(Segment));
+}
+
+/*
+ * FUNCTION publish(string const &, int)
+ *
+ * Adds a score to the best scores, if it is one of them, and to the
+ * log.
+ */
+
+void Shared_Scores::publish(string const & alias, int score)
+{
+    lock();
+    raise(alias, score);
+    unlock();
+
+    uint64_t index{segment -> log_tail.fetch_add(1, memory_order_relaxed)};
+    Entry & entry{segment -> log[index % log_capacity]};
+
+    // Readers skip an entry while its stamp is not its index
+    entry.stamp.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    entry.process = process;
+    strncpy(entry.row.alias, alias.c_str(), alias_size - 1);
+    entry.row.alias[alias_size - 1] = '\0';
+    entry.row.score = score;
+
+    entry.stamp.store(index + 1, memory_order_release);
+}
+
+/*
+ * FUNCTION seed(Rows const &)
+ *
+ * Adds scores to the best scores without adding them to the log.
+ */
+
+void Shared_Scores::seed(Rows const & rows)
+{
+    lock();
+    for (auto && row : rows)
+	raise(row.first, row.second);
+    unlock();
+}
+
+/*
+ * FUNCTION read_top(Rows &, uint32_t &)
+ *
+ * Copies the best scores if the sequence number is not the one
+ * seen, and sets the one seen. Returns false if nothing was copied.
+ */
+
+bool Shared_Scores::read_top(Rows & rows, uint32_t & seen) const
+{
+    if (segment -> sequence.load(memory_order_acquire) == seen)
+	return false;
+
+    Row top[top_capacity];
+    uint32_t count{};
+    uint32_t sequence{};
+
+    while (true)
+    {
+	sequence = segment -> sequence.load(memory_order_acquire);
+	if (sequence % 2 == 1)
+	{
+	    this_thread::yield();
+	    continue;
+	}
+
+	count = min<uint32_t>(segment -> count, top_capacity);
+	memcpy(top, segment -> top, sizeof(top));
+
+	atomic_thread_fence(memory_order_acquire);
+	if (segment -> sequence.load(memory_order_relaxed) == sequence)
+	    break;
+    }
+
+    rows.clear();
+    for (uint32_t index{}; index < count; ++index)
+	rows.emplace_back(string{top[index].alias, strnlen(top[index].alias, alias_size)},
+			  top[index].score);
+
+    seen = sequence;
+    return true;
+}
+
+/*
+ * FUNCTION read_log(uint64_t &, function<void(string const &, int)> const &)
+ *
+ * Calls the function for the scores of other processes from the
+ * index to the end of the log. Stops at an entry that is still being
+ * written, unless it has been for half the ring.
+ */
+
+void Shared_Scores::read_log(uint64_t & next,
+			     function<void(string const &, int)> const & apply) const
+{
+    uint64_t tail{segment -> log_tail.load(memory_order_acquire)};
+
+    if (tail - next > log_capacity)
+	next = tail - log_capacity;
+
+    for (; next < tail; ++next)
+    {
+	Entry const & entry{segment -> log[next % log_capacity]};
+	uint64_t stamp{entry.stamp.load(memory_order_acquire)};
+
+	if (stamp < next + 1 && tail - next < log_capacity / 2)
+	    break;
+	if (stamp != next + 1)
+	    continue;
+
+	int32_t writer{entry.process};
+	Row row{entry.row};
+
+	atomic_thread_fence(memory_order_acquire);
+	if (entry.stamp.load(memory_order_relaxed) != stamp || writer == process)
+	    continue;
+
+	apply(string{row.alias, strnlen(row.alias, alias_size)}, row.score);
+    }
+}
+
+/*
+ * FUNCTION log_end()
+ *
+ * Returns the index after the last score of the log.
+ */
+
+uint64_t Shared_Scores::log_end() const
+{
+    return segment -> log_tail.load(memory_order_acquire);
+}
+
+/*
+ * FUNCTION is_creator()
+ *
+ * Returns true if this process set up the segment.
+ */
+
+bool Shared_Scores::is_creator() const
+{
+    return creator;
+}
+
+/*
+ * FUNCTION remove(string const &)
+ *
+ * Removes a segment. Processes that have it mapped keep it until
+ * they unmap it.
+ */
+
+void Shared_Scores::remove(string const & name)
+{
+    shm_unlink(("/" + name).c_str());
+}
+
+/*
+ * FUNCTION attach(string const &)
+ *
+ * Creates and maps the segment of a path, or maps the one that
+ * exists and waits until it is set up. Returns false, after removing
+ * it, if the segment was not set up in time or has another layout.
+ */
+
+bool Shared_Scores::attach(string const & path)
+{
+    int descriptor{shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666)};
+
+    if (descriptor >= 0)
+    {
+	creator = true;
+	if (ftruncate(descriptor, sizeof(Segment)) != 0)
+	{
+	    close(descriptor);
+	    shm_unlink(path.c_str());
+	    throw invalid_argument("Could not size shared memory " + path + "!");
+	}
+    }
+    else if (errno == EEXIST)
+	descriptor = shm_open(path.c_str(), O_RDWR, 0);
+
+    if (descriptor < 0)
+	throw invalid_argument("Could not open shared memory " + path + "!");
+
+    // The creator may not have sized it yet, any other size is another layout
+    auto start = chrono::steady_clock::now();
+    struct stat status{};
+    while (fstat(descriptor, &status) == 0 && status.st_size == 0 &&
+	   chrono::steady_clock::now() - start < ready_timeout)
+	this_thread::yield();
+
+    void * mapping{MAP_FAILED};
+    if (size_t(status.st_size) == sizeof(Segment))
+	mapping = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED,
+		       descriptor, 0);
+    else if (status.st_size != 0 || chrono::steady_clock::now() - start >= ready_timeout)
+	return forget(descriptor, path);
+
+    if (mapping == MAP_FAILED)
+    {
+	close(descriptor);
+	throw invalid_argument("Could not map shared memory " + path + "!");
+    }
+
+    // A new segment is all zeros, which is an empty list
+    segment = static_cast<Segment *>(mapping);
+    if (creator)
+	segment -> magic.store(segment_magic, memory_order_release);
+
+    uint64_t magic{};
+    while ((magic = segment -> magic.load(memory_order_acquire)) == 0 &&
+	   chrono::steady_clock::now() - start < ready_timeout)
+	this_thread::yield();
+
+    if (magic != segment_magic)
+    {
+	munmap(segment, sizeof(Segment));
+	segment = nullptr;
+	return forget(descriptor, path);
+    }
+
+    close(descriptor);
+    return true;
+}
+
+/*
+ * FUNCTION forget(int, string const &)
+ *
+ * Removes the segment of a descriptor that could not be used, unless
+ * another process has already made a new one in its place. Returns
+ * false.
+ */
+
+bool Shared_Scores::forget(int descriptor, string const & path)
+{
+    if (same_file(descriptor, path))
+	shm_unlink(path.c_str());
+    close(descriptor);
+    return false;
+}
+
+/*
+ * FUNCTION lock()
+ *
+ * Takes the lock of the best scores. A lock held for longer than
+ * lock_timeout by a process that no longer exists is taken over, and
+ * a change it left half done is closed.
+ */
+
+void Shared_Scores::lock()
+{
+    auto start = chrono::steady_clock::now();
+    uint32_t owner{0};
+
+    while (!segment -> owner.compare_exchange_weak(owner, process, memory_order_acquire))
+    {
+	if (owner != 0 && chrono::steady_clock::now() - start > lock_timeout &&
+	    kill(pid_t(owner), 0) != 0 && errno == ESRCH &&
+	    segment -> owner.compare_exchange_strong(owner, process, memory_order_acquire))
+	{
+	    if (segment -> sequence.load(memory_order_relaxed) % 2 == 1)
+		segment -> sequence.fetch_add(1, memory_order_release);
+	    return;
+	}
+
+	owner = 0;
+	this_thread::yield();
+    }
+}
+
+/*
+ * FUNCTION unlock()
+ *
+ * Gives back the lock of the best scores.
+ */
+
+void Shared_Scores::unlock()
+{
+    segment -> owner.store(0, memory_order_release);
+}
+
+/*
+ * FUNCTION raise(string const &, int)
+ *
+ * Puts a score in the best scores if it is better than the one of
+ * the alias and than the last of them. Called with the lock taken.
+ */
+
+void Shared_Scores::raise(string const & alias_string, int score)
+{
+    char alias[alias_size]{};
+    strncpy(alias, alias_string.c_str(), alias_size - 1);
+
+    Row * top{segment -> top};
+    uint32_t count{min<uint32_t>(segment -> count, top_capacity)};
+    uint32_t found{count};
+
+    for (uint32_t index{}; index < count; ++index)
+	if (strncmp(top[index].alias, alias, alias_size) == 0)
+	    found = index;
+
+    if (found < count && top[found].score >= score)
+	return;
+    if (found == count && count == top_capacity &&
+	!better(score, alias, top[count - 1].score, top[count - 1].alias))
+	return;
+
+    segment -> sequence.fetch_add(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // The old row of the alias is taken out, or the last one if full
+    if (found == count && count == top_capacity)
+	found = count - 1;
+    if (found < count)
+    {
+	memmove(top + found, top + found + 1, (count - found - 1) * sizeof(Row));
+	--count;
+    }
+
+    uint32_t place{};
+    while (place < count && !better(score, alias, top[place].score, top[place].alias))
+	++place;
+
+    memmove(top + place + 1, top + place, (count - place) * sizeof(Row));
+    memcpy(top[place].alias, alias, alias_size);
+    top[place].score = score;
+    segment -> count = count + 1;
+
+    segment -> sequence.fetch_add(1, memory_order_release);
+}
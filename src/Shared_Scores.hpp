@@ -0,0 +1,143 @@
+/*
+ * IDENTIFICATION
+ * File name:  Shared_Scores.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Shared_Scores class, a top list in shared
+ * memory for the games running on one machine.
+ */
+
+#ifndef SHARED_SCORES_H
+#define SHARED_SCORES_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* CLASS Shared_Scores
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * A POSIX shared memory segment that every game on the machine maps.
+ * It holds the best top_capacity scores and a log of the last
+ * log_capacity scores, so a score is seen by every game as soon as
+ * it is published, without reading a file or asking a server.
+ *
+ * The best scores are the best score of every alias. They are
+ * changed by one process at a time, under a spin lock in the
+ * segment that holds the id of its owner, so that a lock left by a
+ * process that died is taken over after a second. They are read
+ * without a lock through a sequence number that is odd while they
+ * are changed: a reader copies them and tries again if the number
+ * was odd or changed meanwhile. A reader that only wants to know if
+ * they changed compares the number with the one it saw last.
+ *
+ * The log is a ring. A writer takes the next index with an atomic
+ * add, writes the score and then stamps the entry with its index, so
+ * a reader knows when an entry is whole and when it was written over
+ * by a later score. Every entry has the process id of its writer, so
+ * that a game can skip its own scores.
+ *
+ * The first process to open a segment sets it up, the others wait
+ * until it is ready. The magic number that marks it ready holds a
+ * tag and the size of the layout. A segment that is not ready within
+ * a second, because its creator died, or that has another size or
+ * magic number, left by another version of the game, is removed and
+ * made again. The segment stays until it is removed, also when no
+ * game runs.
+ *
+ * CONSTRUCTORS
+ * Shared_Scores(string const &), the name of the segment
+ *
+ * OPERATIONS
+ * publish, input string const &, int, output none, adds a score to
+ *     the log and to the best scores if it is one of them
+ * seed, input Rows const &, output none, adds scores to the best
+ *     scores only, for the top list of a game that sets up the segment
+ * read_top, input Rows &, uint32_t &, output bool, copies the best
+ *     scores if the sequence number differs from the one given, and
+ *     sets it
+ * read_log, input uint64_t &, function<void(string const &, int)>,
+ *     output none, calls the function for the scores of other
+ *     processes from an index of the log, and moves the index past
+ *     them. Scores written over before they were read are skipped.
+ * log_end, input none, output uint64_t, the index after the last
+ *     score of the log, where a new reader starts
+ * is_creator, input none, output bool
+ * remove, input string const &, output none, (static) removes a
+ *     segment
+ *
+ * DATA MEMBERS
+ * Segment * segment
+ * bool creator
+ * int32_t process, the id of this process
+ */
+
+class Shared_Scores
+{
+public:
+    using Rows = std::vector<std::pair<std::string, int>>;
+
+    static std::size_t const alias_size{32};
+    static std::size_t const top_capacity{16};
+    static std::size_t const log_capacity{4096};
+
+    explicit Shared_Scores(std::string const &);
+    ~Shared_Scores();
+    Shared_Scores(Shared_Scores const &) = delete;
+    Shared_Scores & operator=(Shared_Scores const &) = delete;
+    void publish(std::string const &, int);
+    void seed(Rows const &);
+    bool read_top(Rows &, std::uint32_t &) const;
+    void read_log(std::uint64_t &, std::function<void(std::string const &, int)> const &) const;
+    std::uint64_t log_end() const;
+    bool is_creator() const;
+    static void remove(std::string const &);
+private:
+    struct Row
+    {
+	char alias[alias_size];
+	std::int32_t score;
+    };
+
+    struct Entry
+    {
+	std::atomic<std::uint64_t> stamp;
+	std::int32_t process;
+	Row row;
+    };
+
+    struct Segment
+    {
+	std::atomic<std::uint64_t> magic;
+	std::atomic<std::uint32_t> owner;
+	std::atomic<std::uint32_t> sequence;
+	std::uint32_t count;
+	Row top[top_capacity];
+	std::atomic<std::uint64_t> log_tail;
+	Entry log[log_capacity];
+    };
+
+    bool attach(std::string const &);
+    bool forget(int, std::string const &);
+    void lock();
+    void unlock();
+    void raise(std::string const &, int);
+
+    Segment * segment{nullptr};
+    bool creator{false};
+    std::int32_t process{};
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * IDENTIFICATION
+ * File name:  Startup.cpp
+ * Type:       Definitions for module Startup
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Startup class which times the steps from
+ * the start of the program to the first frame and the first input.
+ */
+
+#include "Startup.hpp"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+ * FUNCTION process_age()
+ *
+ * Returns the seconds since the process was started, read from
+ * /proc, or a negative number when it is not known.
+ */
+
+static double process_age()
+{
+#ifdef __linux__
+    ifstream stat{"/proc/self/stat"};
+    ifstream uptime{"/proc/uptime"};
+    string line{};
+    double seconds_since_boot{};
+
+    if (!getline(stat, line) || !(uptime >> seconds_since_boot))
+	return -1;
+
+    // The name of the program is in parentheses and may hold spaces,
+    // the start time is the 20th field after it
+    istringstream fields{line.substr(line.rfind(')') + 1)};
+    string field{};
+    for (int index{}; index < 20 && fields >> field; ++index)
+	;
+
+    if (!fields)
+	return -1;
+
+    // Both are rounded to 10 ms, which can make a young process
+    // look like it started in the future
+    return max(seconds_since_boot - stod(field) / sysconf(_SC_CLK_TCK), 0.0);
+#else
+    return -1;
+#endif
+}
+
+atomic<bool> Startup::recording{false};
+Startup::Clock::time_point const Startup::static_start{Startup::Clock::now()};
+double const Startup::before_static{process_age()};
+vector<pair<string, Startup::Clock::time_point>> Startup::marks{};
+
+/*
+ * FUNCTION enable()
+ *
+ * Starts saving time stamps.
+ */
+
+void Startup::enable()
+{
+    recording = true;
+}
+
+/*
+ * FUNCTION enabled()
+ *
+ * Returns true while time stamps are saved.
+ */
+
+bool Startup::enabled()
+{
+    return recording;
+}
+
+/*
+ * FUNCTION mark(string const &)
+ *
+ * Saves the time of a step that has just ended and returns the
+ * milliseconds since the process was started.
+ */
+
+double Startup::mark(string const & step)
+{
+    if (!recording)
+	return 0;
+
+    marks.emplace_back(step, Clock::now());
+    return chrono::duration<double, milli>(marks.back().second - static_start).count() +
+	max(before_static, 0.0) * 1000;
+}
+
+/*
+ * FUNCTION finish(ostream &)
+ *
+ * Prints every step with the time it took and the time since the
+ * process was started, then stops saving time stamps.
+ */
+
+void Startup::finish(ostream & out)
+{
+    if (!recording)
+	return;
+    recording = false;
+
+    double offset{max(before_static, 0.0) * 1000};
+    Clock::time_point previous{static_start};
+
+    out << fixed << setprecision(1)
+	<< left << setw(28) << "Startup" << right << setw(10) << "ms"
+	<< setw(10) << "total" << "\n";
+
+    if (before_static >= 0)
+	out << left << setw(28) << "process to static init" << right
+	    << setw(10) << offset << setw(10) << offset << "\n";
+    else
+	out << "(time before static init not known)\n";
+
+    for (auto && step : marks)
+    {
+	out << left << setw(28) << step.first << right
+	    << setw(10) << chrono::duration<double, milli>(step.second - previous).count()
+	    << setw(10) << offset +
+	    chrono::duration<double, milli>(step.second - static_start).count() << "\n";
+	previous = step.second;
+    }
+
+    out << defaultfloat << flush;
+    marks.clear();
+}
@@ -0,0 +1,75 @@
+/*
+ * IDENTIFICATION
+ * File name:  Startup.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Startup class which times the steps from
+ * the start of the program to the first frame and the first input.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* CLASS Startup
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Keeps a time stamp for every step of the startup, like the
+ * construction of each Game_State or the creation of the window,
+ * while it is enabled. The times are counted from when the static
+ * variables of the program were initialized. On Linux the time
+ * before that, from when the process was started, is also read
+ * from /proc, with a resolution of about 10 ms. Marks are only
+ * made from the game thread.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * enable, input none, output none
+ * enabled, input none, output bool
+ * mark, input string const &, output double, saves a time stamp and
+ *     returns the milliseconds since the start, 0 when not enabled
+ * finish, input ostream &, output none, prints the steps and stops
+ *     saving time stamps
+ *
+ * DATA MEMBERS
+ * atomic<bool> recording
+ * time_point static_start
+ * double before_static, seconds from process start to static_start,
+ *     negative when not known
+ * vector<pair<string, time_point>> marks
+ */
+
+class Startup
+{
+public:
+    Startup() = delete;
+    static void enable();
+    static bool enabled();
+    static double mark(std::string const &);
+    static void finish(std::ostream &);
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static std::atomic<bool> recording;
+    static Clock::time_point const static_start;
+    static double const before_static;
+    static std::vector<std::pair<std::string, Clock::time_point>> marks;
+};
+
+#endif
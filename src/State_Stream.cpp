@@ -0,0 +1,231 @@
+/*
+ * IDENTIFICATION
+ * File name:  State_Stream.cpp
+ * Type:       Definitions for module State_Stream
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the State_Writer and State_Reader classes.
+ */
+
+#include "State_Stream.hpp"
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+/*
+ * --------------------------------------------------
+ * ------------------ STATE_WRITER ------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION State_Writer(bool)
+ *
+ * Constructor for State_Writer, a writer that only hashes if true.
+ */
+
+State_Writer::State_Writer(bool hashing_init) :
+    hashing{hashing_init}
+{
+}
+
+/*
+ * FUNCTION write(uint64_t)
+ *
+ * Appends the number as a varint.
+ */
+
+void State_Writer::write(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+	put(static_cast<char>(value | 0x80));
+	value >>= 7;
+    }
+    put(static_cast<char>(value));
+}
+
+/*
+ * FUNCTION write_int(int64_t)
+ *
+ * Appends a signed number, small negative numbers stay short.
+ */
+
+void State_Writer::write_int(int64_t value)
+{
+    write((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+/*
+ * FUNCTION write_float(float)
+ *
+ * Appends the float exactly as four bytes.
+ */
+
+void State_Writer::write_float(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    for (int byte{}; byte < 4; ++byte)
+	put(static_cast<char>(bits >> (8 * byte)));
+}
+
+/*
+ * FUNCTION write_bytes(string const &)
+ *
+ * Appends the length and then the bytes.
+ */
+
+void State_Writer::write_bytes(string const & bytes)
+{
+    write(bytes.size());
+    for (char byte : bytes)
+	put(byte);
+}
+
+/*
+ * FUNCTION get_data()
+ *
+ * Returns everything written so far.
+ */
+
+string const & State_Writer::get_data() const
+{
+    return data;
+}
+
+/*
+ * FUNCTION get_hash()
+ *
+ * Returns the FNV-1a hash of everything written by a writer that
+ * only hashes.
+ */
+
+uint32_t State_Writer::get_hash() const
+{
+    return hash;
+}
+
+/*
+ * FUNCTION put(char)
+ *
+ * Appends a byte, or adds it to the hash.
+ */
+
+void State_Writer::put(char byte)
+{
+    if (hashing)
+	hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+    else
+	data += byte;
+}
+
+/*
+ * --------------------------------------------------
+ * ------------------ STATE_READER ------------------
+ * --------------------------------------------------
+ */
+
+/*
+ * FUNCTION State_Reader(string const &, size_t)
+ *
+ * Constructor for State_Reader, the data must live as long
+ * as the reader.
+ */
+
+State_Reader::State_Reader(string const & data_init, size_t position_init) :
+    data(data_init), position{position_init}
+{
+}
+
+/*
+ * FUNCTION read()
+ *
+ * Reads a varint.
+ */
+
+uint64_t State_Reader::read()
+{
+    uint64_t value{};
+
+    for (int shift{}; shift < 64; shift += 7)
+    {
+	if (position >= data.size())
+	    throw invalid_argument("Saved data is cut off!");
+
+	uint8_t byte = data[position++];
+	value |= uint64_t(byte & 0x7f) << shift;
+
+	if (!(byte & 0x80))
+	    return value;
+    }
+
+    throw invalid_argument("Saved data is broken!");
+}
+
+/*
+ * FUNCTION read_int()
+ *
+ * Reads a signed number.
+ */
+
+int64_t State_Reader::read_int()
+{
+    uint64_t value = read();
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+/*
+ * FUNCTION read_float()
+ *
+ * Reads four bytes as a float.
+ */
+
+float State_Reader::read_float()
+{
+    if (position + 4 > data.size())
+	throw invalid_argument("Saved data is cut off!");
+
+    uint32_t bits{};
+    for (int byte{}; byte < 4; ++byte)
+	bits |= uint32_t(uint8_t(data[position++])) << (8 * byte);
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+ * FUNCTION read_bytes()
+ *
+ * Reads bytes written by write_bytes.
+ */
+
+string State_Reader::read_bytes()
+{
+    uint64_t length = read();
+
+    if (length > data.size() - position)
+	throw invalid_argument("Saved data is cut off!");
+
+    string bytes{data.substr(position, length)};
+    position += length;
+    return bytes;
+}
+
+/*
+ * FUNCTION get_position()
+ *
+ * Returns how far the reader has come.
+ */
+
+size_t State_Reader::get_position() const
+{
+    return position;
+}
@@ -0,0 +1,113 @@
+/*
+ * IDENTIFICATION
+ * File name:  State_Stream.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the State_Writer and State_Reader classes which
+ * write and read compact binary data, used for replays and saved
+ * game states.
+ */
+
+#ifndef STATE_STREAM_H
+#define STATE_STREAM_H
+
+#include <string>
+#include <cstdint>
+
+/* CLASS State_Writer
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Appends numbers to a string. Unsigned numbers are written as
+ * LEB128 varints, seven bits per byte, signed numbers are zigzag
+ * coded first and floats are four bytes little endian.
+ *
+ * A writer that only hashes keeps a 32 bit FNV-1a hash of the bytes
+ * instead of the bytes, so that it never allocates.
+ *
+ * CONSTRUCTORS
+ * State_Writer(), default constructor.
+ * State_Writer(bool), true for a writer that only hashes
+ *
+ * OPERATIONS
+ * write, input uint64_t, output none
+ * write_int, input int64_t, output none
+ * write_float, input float, output none
+ * write_bytes, input string const &, output none
+ * get_data, input none, output string const &, empty when hashing
+ * get_hash, input none, output uint32_t, of the bytes when hashing
+ * put, input char, output none
+ *
+ * DATA MEMBERS
+ * string data
+ * bool hashing
+ * uint32_t hash
+ */
+
+class State_Writer
+{
+public:
+    State_Writer() = default;
+    explicit State_Writer(bool);
+    ~State_Writer() = default;
+    void write(uint64_t);
+    void write_int(int64_t);
+    void write_float(float);
+    void write_bytes(std::string const &);
+    std::string const & get_data() const;
+    uint32_t get_hash() const;
+private:
+    void put(char);
+
+    std::string data{};
+    bool hashing{false};
+    uint32_t hash{2166136261u};
+};
+
+/* CLASS State_Reader
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Reads what a State_Writer wrote. Throws invalid_argument if
+ * the data ends too early or is broken.
+ *
+ * CONSTRUCTORS
+ * State_Reader(string const &, size_t), the data and where to start
+ *
+ * OPERATIONS
+ * read, input none, output uint64_t
+ * read_int, input none, output int64_t
+ * read_float, input none, output float
+ * read_bytes, input none, output string
+ * get_position, input none, output size_t
+ *
+ * DATA MEMBERS
+ * string const & data
+ * size_t position
+ */
+
+class State_Reader
+{
+public:
+    State_Reader(std::string const &, std::size_t = 0);
+    ~State_Reader() = default;
+    uint64_t read();
+    int64_t read_int();
+    float read_float();
+    std::string read_bytes();
+    std::size_t get_position() const;
+private:
+    std::string const & data;
+    std::size_t position{};
+};
+
+#endif
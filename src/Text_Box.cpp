@@ -13,22 +13,20 @@
  */
 
 #include "Text_Box.hpp"
+#include "Assets.hpp"
 
 using namespace std; 
 
 /*
  * CONSTRUCTOR Text_Box()
  *
- * Constructor for Text_Box. Loads and sets the text font, 
+ * Constructor for Text_Box. Sets the text font, 
  * character size and position.
  */
 
 Text_Box::Text_Box() 
 {
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
-
-    text = sf::Text("", font, 23);
+    text = Assets::text("", 23, Assets::TEXT_BOX);
     text.setPosition(1024/2, 325);
 }
 
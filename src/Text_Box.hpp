@@ -33,7 +33,6 @@
  *
  * DATA MEMBERS
  * string alias
- * Font font
  * Text text
  */
 
@@ -48,7 +47,6 @@ public:
 
 private:
     std::string alias{};
-    sf::Font font{};
     sf::Text text{};
 };
 #endif
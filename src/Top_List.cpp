@@ -12,116 +12,440 @@
  */
 
 #include "Top_List.hpp"
+#include "Assets.hpp"
+#include "Startup.hpp"
+#include <iostream>
 
 #define window_width 1024
+#define shown_rows 5
+#define week_seconds (7 * 24 * 60 * 60)
+#define day_seconds (24 * 60 * 60)
 
 using namespace std; 
+
 /*
- * FUNCTION Top_List(string const) 
+ * FUNCTION import_text(string const &, string const &)
  *
- *  takes a string that is a file name that is used to store-
- *  this sessions result in.
+ * Writes a text file as the top list file if that does not exist,
+ * and returns the name of the top list file.
  */
-Top_List::Top_List(string const & file_) :
-    file{file_}
+static string const & import_text(string const & file, string const & text_file)
 {
-    ifstream in_file{file};
-    string alias;
-    int score;
-    
-    while (getline(in_file, alias, ':') >> score >> ws)
-	toplist.emplace(alias, score);
+    if (file.empty() || text_file.empty() || ifstream{file} || !ifstream{text_file})
+	return file;
+
+    Score_File::Changes scores{};
+    Score_Journal::read_scores(text_file, [&scores](string const & alias, int score, time_t)
+			       {
+				   auto found = scores.find(alias);
+
+				   if (found == end(scores))
+				       scores.emplace(alias, score);
+				   else
+				       found -> second = max(found -> second, score);
+			       });
+
+    if (!Score_File::write(file, Score_File{}, scores))
+	throw invalid_argument("Could not import " + text_file + "!");
+
+    return file;
+}
+
+/*
+ * FUNCTION Top_List(string const, string const) 
+ *
+ * Constructor for Top_List. Maps the file the scores are saved to
+ * and loads its journal. An empty file name gives a list that is
+ * never saved. If the file does not exist, the text file is
+ * imported to it first. Scores of the journal that have expired are
+ * not added to the boards of the last week and day. A sketch of the
+ * games that can not be read is left as it is, and not saved to.
+ */
+Top_List::Top_List(string const & file, string const & text_file) :
+    saved{import_text(file, text_file)},
+    week{week_seconds, shown_rows}, day{day_seconds, shown_rows}
+{
+    week.expire(time(nullptr));
+    day.expire(time(nullptr));
 
-    if(!font.loadFromFile("fonts/LCD_Solid.ttf"))
-	throw invalid_argument("Font not found!");
+    if (!file.empty())
+    {
+	journal = make_unique<Score_Journal>(file, [this](string const & alias, int score,
+							  time_t made)
+					     {
+						 set(alias, score, made);
+					     }, week_seconds);
+
+	stats_file = file + ".stats";
+	try
+	{
+	    stats = Score_Sketch::load(stats_file);
+	}
+	catch (invalid_argument const & error)
+	{
+	    cerr << stats_file << ": " << error.what() << endl;
+	    stats_file.clear();
+	}
+    }
+
+    Startup::mark("Top_List loaded");
 }
 
 /*
  * Destructor ~Top_List()
  *
- * Removes the Top_List Object and runs function save_to_file()
+ * Removes the Top_List Object. The journal writes the scores that
+ * are left when it is removed, and the games of this session are
+ * merged into the sketch of the file.
  */
 Top_List::~Top_List()
 {
-    save_to_file(); 
+    journal.reset();
+
+    if (!stats_file.empty() && session_stats.count() > 0 &&
+	!Score_Sketch::update(stats_file, session_stats))
+	cerr << "Could not save " << stats_file << "!" << endl;
+}
+
+/*
+ * FUNCTION insert(string const &, int score, time_t)
+ * 
+ * Sets the score of an alias and hands it, with the time it was
+ * made, to the journal, which saves it on a thread of its own. The
+ * game is not counted in the sketch, see record_game.
+ */
+void Top_List::insert(string const & alias, int score, time_t made)
+{
+    set(alias, score, made);
+
+    if (journal)
+	journal -> append(alias, score, made);
+
+    if (client)
+	client -> submit(alias, score);
+
+    if (shared)
+	shared -> publish(alias, score);
 }
 
 /*
- * FUNCTION insert(string const &, int score)
+ * FUNCTION record_game(int)
  * 
- * sets the toplist variable to the score from this session
+ * Adds the score of a game that ended to the sketch of all games
+ * and to that of this session.
  */
-void Top_List::insert(string const & alias, int score)
+void Top_List::record_game(int score)
 {
-    toplist[alias] = score; 
+    stats.add(score);
+    session_stats.add(score);
 }
-//
-std::vector<pair<string, int>> Top_List::get(unsigned const & list_rows) const
+
+/*
+ * FUNCTION connect(string const &, unsigned short)
+ * 
+ * Sends the scores inserted from now on to a leaderboard server,
+ * and shows its best rows while it can be reached.
+ */
+void Top_List::connect(string const & host, unsigned short port)
 {
-    vector<pair<string, int>> list{begin(toplist), end(toplist)};
-    auto middle = begin(list);
-    
-    if (list.size() >= list_rows)
-	advance( middle, list_rows);
+    client = make_unique<Score_Client>(host, port, shown_rows);
+}
+
+/*
+ * FUNCTION share(string const &)
+ * 
+ * Publishes the scores inserted from now on to a shared memory
+ * segment, takes those the other games publish, and shows its best
+ * rows. Sets up the segment with the best rows of this list if no
+ * game has yet.
+ */
+void Top_List::share(string const & name)
+{
+    shared = make_unique<Shared_Scores>(name);
+
+    if (shared -> is_creator())
+	shared -> seed(get(Shared_Scores::top_capacity));
+
+    shared_next = shared -> log_end();
+    shared_sequence = 1;
+}
+
+/*
+ * FUNCTION set(string const &, int score, time_t)
+ * 
+ * adds a score made at a time to the boards of the last week and
+ * day, and if it is the best of the alias sets the toplist variable
+ * to it, and moves the alias to its new place in the ranking. The
+ * texts are laid out again if the alias was or is among the rows
+ * shown.
+ */
+void Top_List::set(string const & alias, int score, time_t made)
+{
+    week.add(alias, score, made);
+    day.add(alias, score, made);
+
+    auto found = toplist.find(alias);
+    size_t index{saved.size()};
+
+    if (found != end(toplist))
+    {
+	if (found -> second >= score)
+	    return;
+    }
     else
-	middle = end(list);
-    
-    partial_sort(begin(list), middle, end(list),
-		 [](pair<string, int> const& item,
-		    pair<string, int> const& other)->bool
-		 {
-		     if ( item.second == other.second )
-			 return item.first < other.first;
-		     else
-			 return item.second > other.second;
-		 }
-	);
-  
-    list.erase(middle, end(list));
+    {
+	index = saved.find(alias);
+	if (index < saved.size() && saved.score(index) >= score)
+	    return;
+    }
+
+    size_t old_rank{rank(alias)};
+
+    if (found != end(toplist))
+    {
+	ranking.erase(make_pair(found -> second, alias));
+	found -> second = score;
+    }
+    else
+    {
+	if (index < saved.size())
+	    replaced.insert(make_pair(saved.score(index), alias));
+
+	toplist.emplace(alias, score);
+    }
+
+    ranking.insert(make_pair(score, alias));
+
+    if (board == ALL_TIME &&
+	((old_rank > 0 && old_rank <= shown_rows) || rank(alias) <= shown_rows))
+	changed = true;
+}
+
+/*
+ * FUNCTION rank(string const &, Board)
+ * 
+ * Returns the place of an alias on a board, 1 for the best score,
+ * or 0 if the alias is not on it.
+ */
+size_t Top_List::rank(string const & alias, Board wanted) const
+{
+    if (wanted != ALL_TIME)
+	return (wanted == WEEK ? week : day).rank(alias);
+
+    pair<int, string> key{0, alias};
+    auto found = toplist.find(alias);
+
+    if (found != end(toplist))
+	key.first = found -> second;
+    else
+    {
+	size_t index{saved.find(alias)};
+	if (index == saved.size())
+	    return 0;
+	key.first = saved.score(index);
+    }
+
+    // The saved scores that are better, without those replaced, and
+    // the inserted scores that are better
+    return saved.count_better(key.first, alias) - replaced.order_of_key(key) +
+	ranking.order_of_key(key) + 1;
+}
+
+/*
+ * FUNCTION size(Board)
+ * 
+ * Returns the number of aliases on a board.
+ */
+size_t Top_List::size(Board wanted) const
+{
+    if (wanted != ALL_TIME)
+	return (wanted == WEEK ? week : day).size();
+
+    return saved.size() + toplist.size() - replaced.size();
+}
+
+/*
+ * FUNCTION next_board()
+ * 
+ * Shows the next board, after the last the first again.
+ */
+void Top_List::next_board()
+{
+    board = board == ALL_TIME ? WEEK : board == WEEK ? DAY : ALL_TIME;
+    changed = true;
+}
+
+/*
+ * FUNCTION export_text(ostream &)
+ * 
+ * Writes every alias and score as an "alias:score" line, best first.
+ */
+void Top_List::export_text(ostream & out) const
+{
+    for (auto && item : get(size()))
+	out << item.first << ':' << item.second << '\n';
+}
+
+/*
+ * FUNCTION beaten(int)
+ * 
+ * Returns the share of all games with a lower score, from 0 to 1.
+ */
+double Top_List::beaten(int score) const
+{
+    return stats.fraction_below(score);
+}
+
+/*
+ * FUNCTION get_stats()
+ * 
+ * Returns the sketch of all games.
+ */
+Score_Sketch const & Top_List::get_stats() const
+{
+    return stats;
+}
+
+/*
+ * FUNCTION merge_stats(Score_Sketch const &)
+ * 
+ * Adds the games of another sketch, such as that of another machine,
+ * which are saved with those of this session.
+ */
+void Top_List::merge_stats(Score_Sketch const & other)
+{
+    stats.merge(other);
+    session_stats.merge(other);
+}
+
+/*
+ * FUNCTION get(unsigned const &, Board)
+ * 
+ * Returns the list_rows best aliases and their scores on a board,
+ * best first. For all time the saved scores and those inserted are
+ * merged, and the saved scores that were replaced are skipped.
+ */
+std::vector<pair<string, int>> Top_List::get(unsigned const & list_rows, Board wanted) const
+{
+    if (wanted != ALL_TIME)
+	return (wanted == WEEK ? week : day).get(list_rows);
+
+    vector<pair<string, int>> list{};
+    size_t index{};
+    auto item = begin(ranking);
+
+    while (list.size() < list_rows)
+    {
+	while (index < saved.size() && toplist.find(saved.alias(index)) != end(toplist))
+	    ++index;
+
+	if (index < saved.size() &&
+	    (item == end(ranking) ||
+	     Score_Window::Better{}(make_pair(saved.score(index), string{saved.alias(index)}), *item)))
+	{
+	    list.emplace_back(saved.alias(index), saved.score(index));
+	    ++index;
+	}
+	else if (item != end(ranking))
+	{
+	    list.emplace_back(item -> second, item -> first);
+	    ++item;
+	}
+	else
+	    break;
+    }
   
     return list;
 }
 /*
- * FUNCTION save_to_file()
+ * FUNCTION draw(Renderwindow &)
  * 
- * Sends the top liat to the save file
+ * Draws the top_list object, after laying out the texts if the
+ * rows shown have changed since the last time. The scores that
+ * expired since the last frame leave the boards of the last week
+ * and day.
  */
-void Top_List::save_to_file() const
+void Top_List::draw(sf::RenderWindow & window)
 {
-    ofstream out_file{file};
+    time_t now{time(nullptr)};
 
-    for (pair<string, int> const & item : toplist)
-	out_file << item.first << ':' << item.second << endl;
+    week.expire(now);
+    day.expire(now);
+
+    // Both are taken, so that a change of the other is not kept
+    bool week_changed{week.take_changed()};
+    bool day_changed{day.take_changed()};
+
+    if ((board == WEEK && week_changed) || (board == DAY && day_changed))
+	changed = true;
+
+    if (client && client -> take_rows(server_rows))
+	changed = true;
+
+    if (shared)
+    {
+	// The games of other processes count, but they save them
+	shared -> read_log(shared_next, [this, now](string const & alias, int score)
+			   {
+			       set(alias, score, now);
+			       stats.add(score);
+			   });
+
+	if (shared -> read_top(shared_rows, shared_sequence))
+	    changed = true;
+    }
+
+    if (changed)
+	update_text();
+
+    window.draw(highscore);
+    window.draw(text);
 }
+
 /*
- * FUNCTION draw(Renderwindow &)
+ * FUNCTION update_text()
  * 
- * Draws the top_list object
+ * Lays out the heading and the rows shown. The texts are made here
+ * and not in the constructor, so that headless games never need
+ * the font.
  */
-void Top_List::draw(sf::RenderWindow & window) const
+void Top_List::update_text()
 {
-    sf::Text highscore{"Highscore", font, 23};
+    char const * heading{board == WEEK ? "Highscore, 7 days"
+			 : board == DAY ? "Highscore, 24 hours" : "Highscore"};
+
+    highscore = Assets::text(heading, 23, Assets::TOP_LIST);
     sf::FloatRect textRect = highscore.getLocalBounds();
-    sf::Text text{to_string(5), font, 16};
+    text = Assets::text(to_string(shown_rows), 16, Assets::TOP_LIST);
     
     highscore.setOrigin(textRect.width/2, textRect.height/2);
     highscore.setPosition(window_width/2, 570);
-    window.draw(highscore);
     
     textRect = text.getLocalBounds();
     text.setOrigin(textRect.width/2, textRect.height/2);
     text.setPosition(window_width/2, 680);
-    window.draw(text);
+
+    changed = false;
 }
 /*
- * FUNCTION insert(string const &, int score)
+ * FUNCTION to_string(unsigned const &)
  * 
- * sets the toplist variable to the score from this session
+ * Returns the best list_rows rows as text, one alias and score
+ * per row, of the board shown. All time comes from the server when
+ * it can be reached, else from the shared memory segment when shared
  */
 string Top_List::to_string(unsigned const & list_rows) const 
 {
     vector< pair<string, int>> list{}; 
-    list = get(list_rows);
+    if (board != ALL_TIME)
+	list = get(list_rows, board);
+    else if (!server_rows.empty())
+	list = server_rows;
+    else if (shared)
+	list.assign(begin(shared_rows), begin(shared_rows) +
+		    min<size_t>(list_rows, shared_rows.size()));
+    else
+	list = get(list_rows);
 
     ostringstream stream{};
 
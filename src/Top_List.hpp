@@ -23,51 +23,129 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
+#include "Score_Journal.hpp"
+#include "Score_File.hpp"
+#include "Score_Client.hpp"
+#include "Shared_Scores.hpp"
+#include "Score_Window.hpp"
+#include "Score_Sketch.hpp"
  /* CLASS Top_List
  *
  * PARENT CLASS
  * None
  *
  * DESCRIPTION
- * Parent class for all Actors, includes virtual
- * functions used by the child classes and stores
- * their sprites, positions and a few booleans
- * used by the child classes.
- * 
+ * The best score of every alias, saved to a mapped Score_File with
+ * the newer scores kept beside it, and the best scores of the last
+ * week and day in two Score_Windows. Scores are saved by a
+ * Score_Journal on a thread of its own, and can also be sent to a
+ * leaderboard server or shared with the other games on the machine.
+ * The scores of all games are kept in a Score_Sketch, saved to
+ * FILE.stats.
+ *
  * CONSTRUCTORS
- * Actor(), default constructor.
+ * Top_List(string const &, string const &), the file, empty for a
+ *     list never saved, and a text file to import
  *
  * OPERATIONS
- * insert, input string &, output none
+ * insert, input string const &, int, time_t, output none, a score
+ *     and the time it was made, now if not given
+ * record_game, input int, output none, adds the score of a game that
+ *     ended to the sketch of all games
+ * rank, input string const &, Board, output size_t, 1 for the best
+ *     score, 0 for an alias not on the board
+ * size, input Board, output size_t
+ * get, input unsigned const &, Board, output the best rows as alias
+ *     and score
+ * next_board, input none, output none, shows the next board
+ * connect, input string const &, unsigned short, output none, sends
+ *     the scores to a leaderboard server
+ * share, input string const &, output none, shares the scores with
+ *     the other games through a shared memory segment
+ * export_text, input ostream &, output none, writes the list in the
+ *     text format, best first
+ * beaten, input int, output double, the share of all games with a
+ *     lower score, from 0 to 1
+ * get_stats, input none, output Score_Sketch const &, of all games
+ * merge_stats, input Score_Sketch const &, output none, adds the
+ *     games of another sketch
  * draw, input RenderWindow & output none
- * save_to_file, input none, output none
+ * set, input string const &, int, time_t, output none, inserts a
+ *     score made at a time without saving it
+ * update_text, input none, output none
  *
  * DATA MEMBERS
- * vector<std::pair<std::string, int>>
- * string to_string
- * string file
- * map<std::string, int> toplist
- * Font font
+ * unique_ptr<Score_Journal> journal, none for a list never saved
+ * Score_File saved
+ * map<std::string, int> toplist, the scores inserted since
+ * Ranking ranking, the scores inserted, best first
+ * Ranking replaced, the saved scores of aliases in toplist
+ * Score_Window week
+ * Score_Window day
+ * Board board, the one shown
+ * string stats_file, empty for a list never saved
+ * Score_Sketch stats, of all games
+ * Score_Sketch session_stats, of the games added since loaded
+ * unique_ptr<Score_Client> client, none when not connected
+ * Rows server_rows, the rows shown from the server, none when it
+ *     can not be reached
+ * unique_ptr<Shared_Scores> shared, none when not shared
+ * uint64_t shared_next, the next score of the log to take
+ * uint32_t shared_sequence, of the rows last read
+ * Rows shared_rows, the rows shown from the segment
  * Text highscore
  * Text text
+ * bool changed, true when the texts must be laid out again
  */
 class Top_List 
 {
+    friend class Benchmark;
 public:
-    Top_List(std::string const &);
+    enum Board {ALL_TIME, WEEK, DAY};
+
+    Top_List(std::string const &, std::string const & = "");
     ~Top_List();
-    void insert(std::string const &, int);
-    void draw(sf::RenderWindow &) const;
+    void insert(std::string const &, int, std::time_t = std::time(nullptr));
+    void record_game(int);
+    std::size_t rank(std::string const &, Board = ALL_TIME) const;
+    std::size_t size(Board = ALL_TIME) const;
+    std::vector<std::pair<std::string, int>> get(unsigned const &, Board = ALL_TIME) const;
+    void next_board();
+    void connect(std::string const &, unsigned short);
+    void share(std::string const &);
+    void export_text(std::ostream &) const;
+    double beaten(int) const;
+    Score_Sketch const & get_stats() const;
+    void merge_stats(Score_Sketch const &);
+    void draw(sf::RenderWindow &);
 private:
-    void save_to_file() const;
-    std::vector<std::pair<std::string, int>> get(unsigned const &) const;
+    using Ranking = Score_Window::Ranking;
+
+    void set(std::string const &, int, std::time_t);
     std::string to_string(unsigned const &) const;
+    void update_text();
     
-    std::string file;
-    std::map<std::string, int> toplist{};
-    sf::Font font{};
+    std::unique_ptr<Score_Journal> journal{};
+    Score_File saved{};
+    std::map<std::string, int, std::less<>> toplist{};
+    Ranking ranking{};
+    Ranking replaced{};
+    Score_Window week;
+    Score_Window day;
+    Board board{ALL_TIME};
+    std::string stats_file{};
+    Score_Sketch stats{};
+    Score_Sketch session_stats{};
+    std::unique_ptr<Score_Client> client{};
+    Score_Client::Rows server_rows{};
+    std::unique_ptr<Shared_Scores> shared{};
+    std::uint64_t shared_next{};
+    std::uint32_t shared_sequence{1};
+    Shared_Scores::Rows shared_rows{};
     sf::Text highscore{};
     sf::Text text{};
+    bool changed{true};
 };
 
 #endif
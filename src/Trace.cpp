@@ -0,0 +1,164 @@
+/*
+ * IDENTIFICATION
+ * File name:  Trace.cpp
+ * Type:       Definitions for module Trace
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Definitions for the Trace class which records spans and instants
+ * and saves them as Chrome trace JSON.
+ */
+
+#include "Trace.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+mutex Trace::buffers_mutex{};
+vector<unique_ptr<Trace::Buffer>> Trace::buffers{};
+
+/*
+ * FUNCTION Span(char const *)
+ *
+ * Constructor for Span, notes when the span starts.
+ */
+
+Trace::Span::Span(char const * name_init) :
+    name{name_init}, start{now()}
+{}
+
+/*
+ * FUNCTION ~Span()
+ *
+ * Destructor for Span, records the span.
+ */
+
+Trace::Span::~Span()
+{
+    record(name, start, now() - start);
+}
+
+/*
+ * FUNCTION now()
+ *
+ * Returns the time of the steady clock in nanoseconds.
+ */
+
+int64_t Trace::now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+	chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * FUNCTION instant(char const *)
+ *
+ * Records something that happened now, like a new wave of enemies.
+ */
+
+void Trace::instant(char const * name)
+{
+    record(name, now(), -1);
+}
+
+/*
+ * FUNCTION record(char const *, int64_t, int64_t)
+ *
+ * Writes an event to the buffer of this thread. The count is
+ * stored after the event so that dump never reads a half written one.
+ */
+
+void Trace::record(char const * name, int64_t start, int64_t duration)
+{
+    Buffer & local = buffer();
+    uint64_t written = local.written.load(memory_order_relaxed);
+
+    local.events[written % capacity] = Event{name, start, duration};
+    local.written.store(written + 1, memory_order_release);
+}
+
+/*
+ * FUNCTION dump(string const &)
+ *
+ * Saves the events of every thread as Chrome trace JSON. Threads may
+ * keep recording meanwhile, events that could have been overwritten
+ * while they were copied are left out.
+ */
+
+void Trace::dump(string const & file)
+{
+    vector<pair<size_t, Event>> events{};
+
+    {
+	lock_guard<mutex> lock{buffers_mutex};
+
+	for (auto && local : buffers)
+	{
+	    uint64_t end = local -> written.load(memory_order_acquire);
+	    uint64_t begin = end > capacity ? end - capacity : 0;
+	    vector<Event> copy{};
+
+	    for (uint64_t index{begin}; index < end; ++index)
+		copy.push_back(local -> events[index % capacity]);
+
+	    // The writer may be filling the slot of event now_written
+	    // before it publishes it, so that slot is not safe either
+	    uint64_t now_written = local -> written.load(memory_order_acquire);
+	    uint64_t safe = now_written >= capacity ? now_written - capacity + 1 : 0;
+
+	    for (uint64_t index{max(begin, safe)}; index < end; ++index)
+		events.emplace_back(local -> thread, copy[index - begin]);
+	}
+    }
+
+    ofstream out{file};
+    out << fixed << setprecision(3) << "{\"traceEvents\":[";
+
+    bool first{true};
+    for (auto && event : events)
+    {
+	out << (first ? "\n" : ",\n")
+	    << "{\"name\":\"" << event.second.name
+	    << "\",\"pid\":1,\"tid\":" << event.first
+	    << ",\"ts\":" << event.second.start / 1000.0;
+
+	if (event.second.duration < 0)
+	    out << ",\"ph\":\"i\",\"s\":\"t\"}";
+	else
+	    out << ",\"ph\":\"X\",\"dur\":" << event.second.duration / 1000.0 << "}";
+
+	first = false;
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (!out)
+	throw invalid_argument("Could not write trace to " + file + "!");
+}
+
+/*
+ * FUNCTION buffer()
+ *
+ * Returns the buffer of this thread, adds it on first use.
+ */
+
+Trace::Buffer & Trace::buffer()
+{
+    thread_local Buffer * local{nullptr};
+
+    if (local == nullptr)
+    {
+	lock_guard<mutex> lock{buffers_mutex};
+	buffers.push_back(make_unique<Buffer>());
+	local = buffers.back().get();
+	local -> thread = buffers.size();
+    }
+
+    return *local;
+}
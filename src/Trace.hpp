@@ -0,0 +1,117 @@
+/*
+ * IDENTIFICATION
+ * File name:  Trace.hpp
+ * Type:       Module declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Declarations for the Trace class and the trace markers. The
+ * markers record spans and instants that are saved as Chrome trace
+ * JSON, which chrome://tracing and Perfetto can open.
+ *
+ * The markers are only compiled in when PSI_TRACE is defined
+ * ('make TRACE=1'), otherwise they expand to nothing:
+ *   TRACE_SCOPE(name)   span from here to the end of the scope
+ *   TRACE_INSTANT(name) a single point in time
+ *   TRACE_DUMP(file)    saves everything recorded so far
+ * The name must be a string literal.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef PSI_TRACE
+#define TRACE_JOIN(a, b) a##b
+#define TRACE_NAME(line) TRACE_JOIN(trace_span_, line)
+#define TRACE_SCOPE(name) Trace::Span TRACE_NAME(__LINE__){name}
+#define TRACE_INSTANT(name) Trace::instant(name)
+#define TRACE_DUMP(file) Trace::dump(file)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_DUMP(file) ((void)0)
+#endif
+
+/* CLASS Trace
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Every thread writes its events to its own ring buffer, so that
+ * recording needs no lock. Only the first event of a thread takes
+ * the lock, to add the buffer of the thread. When a buffer is full
+ * the oldest events are overwritten. The buffers are kept after
+ * their thread ends so that they can still be dumped.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ * Span(char const *), records a span when it is destroyed
+ *
+ * OPERATIONS
+ * now, input none, output int64_t, nanoseconds of the steady clock
+ * instant, input char const *, output none
+ * record, input char const *, int64_t, int64_t, output none
+ * dump, input string const &, output none
+ *
+ * DATA MEMBERS
+ * mutex buffers_mutex
+ * vector<unique_ptr<Buffer>> buffers
+ */
+
+class Trace
+{
+public:
+    class Span
+    {
+    public:
+	explicit Span(char const *);
+	~Span();
+	Span(Span const &) = delete;
+	Span & operator=(Span const &) = delete;
+    private:
+	char const * name;
+	int64_t start;
+    };
+
+    Trace() = delete;
+    static int64_t now();
+    static void instant(char const *);
+    static void record(char const *, int64_t, int64_t);
+    static void dump(std::string const &);
+private:
+    static std::size_t const capacity{1 << 15};
+
+    // duration is -1 for an instant
+    struct Event
+    {
+	char const * name;
+	int64_t start;
+	int64_t duration;
+    };
+
+    struct Buffer
+    {
+	std::array<Event, capacity> events;
+	std::atomic<uint64_t> written;
+	std::size_t thread;
+    };
+
+    static Buffer & buffer();
+
+    static std::mutex buffers_mutex;
+    static std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+#endif
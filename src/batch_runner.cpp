@@ -0,0 +1,260 @@
+/*
+ * IDENTIFICATION
+ * File name:  batch_runner.cpp
+ * Type:       Main program for batch simulations
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Plays many headless games with bots on all cores and prints
+ * statistics of the outcomes as JSON. Used to tune the difficulty.
+ *
+ * USAGE
+ * batch_runner [--games N] [--threads N] [--seed N] [--bot NAME]...
+ *              [--max-time SECONDS] [--columns N] [--rows N]
+ *              [--shot-chance N] [--shot-delay SECONDS]
+ *              [--boss-interval SECONDS]
+ */
+
+#include "Game.hpp"
+#include "Game_State.hpp"
+#include "Bot.hpp"
+#include "Trace.hpp"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+using namespace std;
+
+struct Job
+{
+    unsigned seed{};
+    string bot{};
+};
+
+struct Result
+{
+    int score{};
+    float time{};
+    int wave{};
+    bool lost{};
+};
+
+/*
+ * FUNCTION play(Job const &, Difficulty const &, float)
+ *
+ * Plays one game at 60 frames per second until the player
+ * loses or max_time seconds have passed.
+ */
+
+Result play(Job const & job, Difficulty const & difficulty, float max_time)
+{
+    Game game{true};
+    Field field{game, job.seed, difficulty};
+    sf::Time delta{Field::tick};
+
+    field.set_input(make_unique<Bot>(job.bot, job.seed));
+
+    while (!field.is_over() && field.get_time() < max_time)
+	field.update(delta);
+
+    return Result{field.get_score(), field.get_time(),
+	    field.get_wave(), field.is_over()};
+}
+
+/*
+ * FUNCTION percentile(vector<float>, double)
+ *
+ * Returns the nearest rank percentile of a sorted vector.
+ */
+
+float percentile(vector<float> const & sorted, double fraction)
+{
+    if (sorted.empty())
+	return 0;
+
+    size_t rank = fraction * (sorted.size() - 1) + 0.5;
+    return sorted.at(rank);
+}
+
+/*
+ * FUNCTION print_distribution(string const &, vector<float>)
+ *
+ * Prints mean, min, max and percentiles of the values as a JSON object.
+ */
+
+void print_distribution(string const & name, vector<float> values)
+{
+    sort(begin(values), end(values));
+    double mean = values.empty() ? 0 :
+	accumulate(begin(values), end(values), 0.0) / values.size();
+
+    cout << "      \"" << name << "\": {"
+	 << "\"mean\": " << mean
+	 << ", \"min\": " << percentile(values, 0.0)
+	 << ", \"p10\": " << percentile(values, 0.1)
+	 << ", \"p50\": " << percentile(values, 0.5)
+	 << ", \"p90\": " << percentile(values, 0.9)
+	 << ", \"p99\": " << percentile(values, 0.99)
+	 << ", \"max\": " << percentile(values, 1.0) << "}";
+}
+
+int main(int argc, char * argv[])
+{
+    int games{100};
+    unsigned threads{max(thread::hardware_concurrency(), 1u)};
+    unsigned seed{1};
+    float max_time{600};
+    vector<string> bots{};
+    Difficulty difficulty{};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    string value{argv[++index]};
+
+	    if (option == "--games")
+		games = stoi(value);
+	    else if (option == "--threads")
+		threads = max(stoi(value), 1);
+	    else if (option == "--seed")
+		seed = stoul(value);
+	    else if (option == "--bot")
+		bots.push_back(value);
+	    else if (option == "--max-time")
+		max_time = stof(value);
+	    else if (option == "--columns")
+		difficulty.enemy_columns = stoi(value);
+	    else if (option == "--rows")
+		difficulty.enemy_rows = stoi(value);
+	    else if (option == "--shot-chance")
+		difficulty.enemy_shot_chance = max(stoi(value), 1);
+	    else if (option == "--shot-delay")
+		difficulty.enemy_shot_delay = stof(value);
+	    else if (option == "--boss-interval")
+		difficulty.boss_interval = stof(value);
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 1;
+    }
+
+    if (bots.empty())
+	bots.push_back("sweeper");
+
+    // One job per seed and bot, the workers take the next job when done
+    vector<Job> jobs{};
+    for (string const & bot : bots)
+	for (int game{}; game < games; ++game)
+	    jobs.push_back(Job{seed + game, bot});
+
+    vector<Result> results(jobs.size());
+    atomic<size_t> next_job{0};
+    atomic<bool> failed{false};
+    string error_message{};
+
+    auto worker = [&]()
+	{
+	    try
+	    {
+		for (size_t job{next_job++}; job < jobs.size(); job = next_job++)
+		    results.at(job) = play(jobs.at(job), difficulty, max_time);
+	    }
+	    catch (exception const & error)
+	    {
+		if (!failed.exchange(true))
+		    error_message = error.what();
+		next_job = jobs.size();
+	    }
+	};
+
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers{};
+    for (unsigned count{}; count < threads; ++count)
+	workers.emplace_back(worker);
+    for (thread & thread : workers)
+	thread.join();
+    TRACE_DUMP("trace.json");
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (failed)
+    {
+	cerr << error_message << endl;
+	return 1;
+    }
+
+    cout << "{\n"
+	 << "  \"threads\": " << threads << ",\n"
+	 << "  \"games\": " << jobs.size() << ",\n"
+	 << "  \"elapsed_seconds\": " << elapsed << ",\n"
+	 << "  \"games_per_second\": " << jobs.size() / elapsed << ",\n"
+	 << "  \"difficulty\": {"
+	 << "\"columns\": " << difficulty.enemy_columns
+	 << ", \"rows\": " << difficulty.enemy_rows
+	 << ", \"shot_chance\": " << difficulty.enemy_shot_chance
+	 << ", \"shot_delay\": " << difficulty.enemy_shot_delay
+	 << ", \"boss_interval\": " << difficulty.boss_interval << "},\n"
+	 << "  \"bots\": [\n";
+
+    for (size_t bot{}; bot < bots.size(); ++bot)
+    {
+	vector<float> scores{};
+	vector<float> times{};
+	vector<float> waves{};
+	int lost{};
+
+	for (size_t job{}; job < jobs.size(); ++job)
+	    if (jobs.at(job).bot == bots.at(bot))
+	    {
+		scores.push_back(results.at(job).score);
+		times.push_back(results.at(job).time);
+		waves.push_back(results.at(job).wave);
+		lost += results.at(job).lost;
+	    }
+
+	cout << "    {\n"
+	     << "      \"bot\": \"" << bots.at(bot) << "\",\n"
+	     << "      \"games\": " << scores.size() << ",\n"
+	     << "      \"lost\": " << lost << ",\n";
+	print_distribution("score", scores);
+	cout << ",\n";
+	print_distribution("survival_time", times);
+	cout << ",\n";
+	print_distribution("wave", waves);
+	cout << "\n    }" << (bot + 1 < bots.size() ? "," : "") << "\n";
+    }
+
+    cout << "  ],\n"
+	 << "  \"results\": [\n";
+
+    for (size_t job{}; job < jobs.size(); ++job)
+    {
+	cout << "    {\"seed\": " << jobs.at(job).seed
+	     << ", \"bot\": \"" << jobs.at(job).bot << "\""
+	     << ", \"score\": " << results.at(job).score
+	     << ", \"time\": " << results.at(job).time
+	     << ", \"wave\": " << results.at(job).wave
+	     << ", \"lost\": " << (results.at(job).lost ? "true" : "false") << "}"
+	     << (job + 1 < jobs.size() ? "," : "") << "\n";
+    }
+
+    cout << "  ]\n}" << endl;
+
+    return 0;
+}
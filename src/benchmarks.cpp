@@ -0,0 +1,412 @@
+/*
+ * IDENTIFICATION
+ * File name:  benchmarks.cpp
+ * Type:       Main program for microbenchmarks
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Times the simulation kernels of the Field and the queries of the
+ * Top_List on synthetic scenes from 10 to 100000 entities, and
+ * prints the times as JSON so that the growth of each kernel can be
+ * followed between releases.
+ *
+ * USAGE
+ * benchmarks [--filter TEXT] [--max-entities N] [--min-time SECONDS]
+ *            [--max-time SECONDS]
+ */
+
+#include "Game.hpp"
+#include "Game_State.hpp"
+#include "Top_List.hpp"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+#define grid_spacing 60
+#define grid_rows 10
+#define toplist_rows 5
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Options
+{
+    string filter{};
+    size_t max_entities{100000};
+    double min_time{0.2};
+    double max_time{2.0};
+};
+
+struct Result
+{
+    size_t entities{};
+    uint64_t iterations{};
+    double nanoseconds{};
+    bool skipped{};
+};
+
+/* CLASS Benchmark
+ *
+ * PARENT CLASS
+ * None
+ *
+ * DESCRIPTION
+ * Builds the synthetic scenes and runs the kernels, it is a friend
+ * of Field and Top_List to reach their private functions. The scenes
+ * are headless Fields where the entities are laid out on a grid so
+ * that nothing overlaps, which makes every collision test a miss and
+ * keeps the scene the same between iterations. There is no player,
+ * so the game can not be lost.
+ *
+ * CONSTRUCTORS
+ * None, only static members.
+ *
+ * OPERATIONS
+ * make_field, input Game &, output unique_ptr<Field>, an empty Field
+ * fill, input Field &, size_t, size_t, output none, adds enemies
+ *     and projectiles
+ * collision_control, input Field &, output none
+ * actor_update, input Field &, output none
+ * make_enemies_shoot, input Field &, output none
+ * projectile_update, input Field &, output none
+ * toplist_get, input Top_List const &, output none
+ */
+
+class Benchmark
+{
+public:
+    Benchmark() = delete;
+
+    static unique_ptr<Field> make_field(Game & game)
+    {
+	unique_ptr<Field> field{make_unique<Field>(game, 1)};
+	field -> actors.clear();
+	field -> projectiles.clear();
+	return field;
+    }
+
+    static void fill(Field & field, size_t enemies, size_t projectiles)
+    {
+	field.actors.clear();
+	field.projectiles.clear();
+
+	// Enemies and projectiles take turns in the cells of the grid,
+	// which grows to the right so that everything stays between the
+	// top and bottom of the screen. Every tenth projectile is put
+	// below the screen and is removed.
+	for (size_t cell{}; cell < enemies + projectiles; ++cell)
+	{
+	    float x = grid_spacing * (cell / grid_rows);
+	    float y = 100 + grid_spacing * (cell % grid_rows);
+
+	    if (field.projectiles.size() >= projectiles ||
+		(field.actors.size() < enemies && cell % 2 == 0))
+		field.actors.push_back(make_unique<Enemy>
+				       (x, y + 200, cell % 4 + 1, field.difficulty));
+	    else
+	    {
+		bool removed{field.projectiles.size() % 10 == 9};
+		field.projectiles.push_back(make_unique<Projectile>
+					    (sf::Vector2f{x, removed ? 800 : y}, false));
+	    }
+	}
+    }
+
+    static void collision_control(Field & field)
+    {
+	field.collision_control();
+    }
+
+    static void actor_update(Field & field)
+    {
+	sf::Time delta{Field::tick};
+	field.actor_update(delta);
+    }
+
+    static void make_enemies_shoot(Field & field)
+    {
+	field.make_enemies_shoot();
+    }
+
+    static void projectile_update(Field & field)
+    {
+	sf::Time delta{Field::tick};
+	field.projectile_update(delta);
+    }
+
+    static void toplist_get(Top_List const & toplist)
+    {
+	toplist.get(toplist_rows);
+    }
+};
+
+/*
+ * FUNCTION measure(size_t, Options const &, function<void()>, function<void()>)
+ *
+ * Runs the kernel until it has taken min_time seconds, or the whole
+ * benchmark max_time seconds, but at least once. The setup is run
+ * before every run of the kernel and is not timed.
+ */
+
+Result measure(size_t entities, Options const & options,
+	       function<void()> const & setup, function<void()> const & kernel)
+{
+    Clock::duration timed{};
+    Clock::time_point start{Clock::now()};
+    Result result{entities};
+
+    do
+    {
+	setup();
+	Clock::time_point begin{Clock::now()};
+	kernel();
+	timed += Clock::now() - begin;
+	++result.iterations;
+    }
+    while (chrono::duration<double>(timed).count() < options.min_time &&
+	   chrono::duration<double>(Clock::now() - start).count() < options.max_time);
+
+    result.nanoseconds = chrono::duration<double, nano>(timed).count() / result.iterations;
+    return result;
+}
+
+/*
+ * FUNCTION exponent(vector<Result> const &)
+ *
+ * Fits time = c * entities^k to the measured sizes with least squares
+ * on the logarithms and returns k, 1 for a linear kernel and 2 for a
+ * quadratic one. Sizes under 100 are left out, they mostly measure
+ * the constant overhead.
+ */
+
+double exponent(vector<Result> const & results)
+{
+    double count{}, sum_x{}, sum_y{}, sum_xx{}, sum_xy{};
+
+    for (Result const & result : results)
+	if (!result.skipped && result.entities >= 100 && result.nanoseconds > 0)
+	{
+	    double x{log(double(result.entities))};
+	    double y{log(result.nanoseconds)};
+	    ++count;
+	    sum_x += x;
+	    sum_y += y;
+	    sum_xx += x * x;
+	    sum_xy += x * y;
+	}
+
+    if (count < 2)
+	return 0;
+
+    return (count * sum_xy - sum_x * sum_y) / (count * sum_xx - sum_x * sum_x);
+}
+
+/*
+ * FUNCTION sweep(string const &, Options const &, bool &, function<Result(size_t)>)
+ *
+ * Runs a benchmark for 10, 30, 100, ... up to max_entities entities
+ * and prints it as a JSON object, after a comma unless it is the
+ * first. The run function is given the size and returns the result. Once a single run took longer than max_time
+ * the larger sizes are skipped, the quadratic kernels would take
+ * minutes at 100000 entities.
+ */
+
+void sweep(string const & name, Options const & options, bool & first,
+	   function<Result(size_t)> const & run)
+{
+    if (name.find(options.filter) == string::npos)
+	return;
+
+    vector<Result> results{};
+    bool too_slow{false};
+
+    for (size_t entities{10}; entities <= options.max_entities;
+	 entities = entities % 3 == 0 ? entities * 10 / 3 : entities * 3)
+    {
+	if (too_slow)
+	{
+	    results.push_back(Result{entities, 0, 0, true});
+	    continue;
+	}
+
+	cerr << name << " " << entities << endl;
+	results.push_back(run(entities));
+
+	too_slow = results.back().nanoseconds / 1e9 > options.max_time;
+    }
+
+    cout << (first ? "" : ",\n")
+	 << "    {\n"
+	 << "      \"name\": \"" << name << "\",\n"
+	 << "      \"exponent\": " << exponent(results) << ",\n"
+	 << "      \"sizes\": [\n";
+
+    for (size_t index{}; index < results.size(); ++index)
+    {
+	Result const & result{results.at(index)};
+	cout << "        {\"entities\": " << result.entities;
+	if (result.skipped)
+	    cout << ", \"skipped\": true}";
+	else
+	    cout << ", \"iterations\": " << result.iterations
+		 << ", \"ns_per_iteration\": " << result.nanoseconds
+		 << ", \"ns_per_entity\": " << result.nanoseconds / result.entities << "}";
+	cout << (index + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    cout << "      ]\n    }";
+    first = false;
+}
+
+int main(int argc, char * argv[])
+{
+    Options options{};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    string value{argv[++index]};
+
+	    if (option == "--filter")
+		options.filter = value;
+	    else if (option == "--max-entities")
+		options.max_entities = stoul(value);
+	    else if (option == "--min-time")
+		options.min_time = stod(value);
+	    else if (option == "--max-time")
+		options.max_time = stod(value);
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 1;
+    }
+
+    Game game{true};
+    bool first{true};
+
+    cout << "{\n"
+	 << "  \"min_time\": " << options.min_time << ",\n"
+	 << "  \"max_time\": " << options.max_time << ",\n"
+	 << "  \"benchmarks\": [\n";
+
+    // Half enemies and half projectiles, the scene does not change
+    sweep("Field::collision_control", options, first, [&options, &game](size_t entities)
+	  {
+	      unique_ptr<Field> field{Benchmark::make_field(game)};
+	      Benchmark::fill(*field, entities / 2, entities - entities / 2);
+	      return measure(entities, options, []() {},
+			     [&field]() { Benchmark::collision_control(*field); });
+	  });
+
+    // Enemies only, they move a little every iteration
+    sweep("Field::actor_update", options, first, [&options, &game](size_t entities)
+	  {
+	      unique_ptr<Field> field{Benchmark::make_field(game)};
+	      Benchmark::fill(*field, entities, 0);
+	      return measure(entities, options, []() {},
+			     [&field]() { Benchmark::actor_update(*field); });
+	  });
+
+    sweep("Field::make_enemies_shoot", options, first, [&options, &game](size_t entities)
+	  {
+	      unique_ptr<Field> field{Benchmark::make_field(game)};
+	      Benchmark::fill(*field, entities, 0);
+	      return measure(entities, options, []() {},
+			     [&field]() { Benchmark::make_enemies_shoot(*field); });
+	  });
+
+    // Projectiles only, rebuilt before every run since a tenth of
+    // them are removed
+    sweep("Field::projectile_update", options, first, [&options, &game](size_t entities)
+	  {
+	      unique_ptr<Field> field{Benchmark::make_field(game)};
+	      return measure(entities, options,
+			     [&field, entities]() { Benchmark::fill(*field, 0, entities); },
+			     [&field]() { Benchmark::projectile_update(*field); });
+	  });
+
+    // One player per entity, the game shows the best five
+    sweep("Top_List::get", options, first, [&options](size_t entities)
+	  {
+	      Top_List toplist{""};
+	      Random_Engine random_engine{1};
+	      for (size_t player{}; player < entities; ++player)
+		  toplist.insert("player" + to_string(player), random_engine() % 100000);
+
+	      return measure(entities, options, []() {},
+			     [&toplist]() { Benchmark::toplist_get(toplist); });
+	  });
+
+    // The rank of a player in the middle of the list
+    sweep("Top_List::rank", options, first, [&options](size_t entities)
+	  {
+	      Top_List toplist{""};
+	      Random_Engine random_engine{1};
+	      for (size_t player{}; player < entities; ++player)
+		  toplist.insert("player" + to_string(player), random_engine() % 100000);
+
+	      string alias{"player" + to_string(entities / 2)};
+	      return measure(entities, options, []() {},
+			     [&toplist, &alias]() { toplist.rank(alias); });
+	  });
+
+    // A window of one score a second, where every run adds a score
+    // and expires the oldest, as a day or week board does
+    sweep("Score_Window add and expire", options, first, [&options](size_t entities)
+	  {
+	      Score_Window window{time_t(entities), toplist_rows};
+	      Random_Engine random_engine{1};
+	      time_t now{};
+	      for (; now < time_t(entities); ++now)
+		  window.add("player" + to_string(random_engine() % entities),
+			     random_engine() % 100000, now);
+
+	      return measure(entities, options, []() {},
+			     [&window, &random_engine, &now, entities]()
+			     {
+				 window.add("player" + to_string(random_engine() % entities),
+					    random_engine() % 100000, now);
+				 window.expire(++now);
+			     });
+	  });
+
+    // Opening a saved list and reading the rows shown, which should
+    // not depend on the size of the list
+    sweep("Top_List load", options, first, [&options](size_t entities)
+	  {
+	      string const file{"benchmarks_toplist.bin"};
+	      Score_File::Changes scores{};
+	      Random_Engine random_engine{1};
+	      for (size_t player{}; player < entities; ++player)
+		  scores["player" + to_string(player)] = random_engine() % 100000;
+	      Score_File::write(file, Score_File{}, scores);
+
+	      Result result{measure(entities, options, []() {}, [&file]()
+				    {
+					Top_List toplist{file};
+					Benchmark::toplist_get(toplist);
+				    })};
+
+	      remove(file.c_str());
+	      remove((file + ".journal").c_str());
+	      return result;
+	  });
+
+    cout << "\n  ]\n}" << endl;
+}
@@ -0,0 +1,155 @@
+/*
+ * IDENTIFICATION
+ * File name:  leaderboard_server.cpp
+ * Type:       Main program for the leaderboard server
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Serves one top list to the games started with --leaderboard, until
+ * it gets SIGINT or SIGTERM. Only games on this machine can reach it
+ * unless --bind gives another address to listen on, such as 0.0.0.0
+ * for the games of every machine on the network. With --load-test
+ * it instead plays many games against a running server, which all
+ * send their scores at once, and prints how many scores a second
+ * the server saved.
+ *
+ * USAGE
+ * leaderboard_server [--port PORT] [--bind ADDRESS] [--file FILE]
+ * leaderboard_server --load-test HOST:PORT [--games N] [--scores N]
+ */
+
+#include "Score_Server.hpp"
+#include "Score_Client.hpp"
+#include <iostream>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+static volatile sig_atomic_t stop_requested{0};
+
+static void request_stop(int)
+{
+    stop_requested = 1;
+}
+
+/*
+ * FUNCTION load_test(string const &, unsigned, unsigned)
+ *
+ * Sends scores from many clients at once, each with a thread of its
+ * own like a game, and waits until the server has saved them all or
+ * nothing was saved for a few seconds. Returns 0 if all were saved.
+ */
+
+int load_test(string const & server, unsigned games, unsigned scores)
+{
+    size_t colon{server.rfind(':')};
+    if (colon == string::npos)
+	throw invalid_argument("Expected HOST:PORT, not " + server + "!");
+
+    string host{server.substr(0, colon)};
+    unsigned short port = stoi(server.substr(colon + 1));
+    uint64_t expected{uint64_t(games) * scores};
+
+    vector<unique_ptr<Score_Client>> clients{};
+    for (unsigned game{}; game < games; ++game)
+	clients.push_back(make_unique<Score_Client>(host, port, 5));
+
+    auto start = chrono::steady_clock::now();
+    auto progress = start;
+    uint64_t saved{};
+
+    for (unsigned score{}; score < scores; ++score)
+	for (unsigned game{}; game < games; ++game)
+	    clients.at(game) -> submit("load" + to_string(game) + "_" + to_string(score),
+				       score);
+
+    while (saved < expected && chrono::steady_clock::now() - progress < chrono::seconds(15))
+    {
+	this_thread::sleep_for(chrono::milliseconds(1));
+
+	uint64_t total{};
+	for (auto && client : clients)
+	    total += client -> get_acknowledged();
+
+	if (total > saved)
+	    progress = chrono::steady_clock::now();
+	saved = total;
+    }
+
+    chrono::duration<double> elapsed{chrono::steady_clock::now() - start};
+
+    cout << "games:   " << games << "\n"
+	 << "scores:  " << saved << " of " << expected << " saved\n"
+	 << "time:    " << elapsed.count() << " s\n"
+	 << "rate:    " << saved / elapsed.count() << " scores/s" << endl;
+
+    return saved >= expected ? 0 : 1;
+}
+
+int main(int argc, char * argv[])
+{
+    string file{"Top_List/server.bin"};
+    unsigned short port{7777};
+    sf::IpAddress address{sf::IpAddress::LocalHost};
+    string load_server{};
+    unsigned games{16};
+    unsigned scores{10000};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    string value{argv[++index]};
+
+	    if (option == "--port")
+		port = stoi(value);
+	    else if (option == "--bind")
+	    {
+		address = sf::IpAddress{value};
+		if (address == sf::IpAddress::None)
+		    throw invalid_argument(value + " is not an address!");
+	    }
+	    else if (option == "--file")
+		file = value;
+	    else if (option == "--load-test")
+		load_server = value;
+	    else if (option == "--games")
+		games = max(stoi(value), 1);
+	    else if (option == "--scores")
+		scores = max(stoi(value), 1);
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+
+	if (!load_server.empty())
+	    return load_test(load_server, games, scores);
+
+	signal(SIGINT, request_stop);
+	signal(SIGTERM, request_stop);
+
+	Score_Server score_server{file, port, address};
+	cerr << "Serving " << file << " on " << address.toString() << " port "
+	     << score_server.get_port() << endl;
+
+	score_server.run(stop_requested);
+	cerr << score_server.get_submissions() << " scores saved" << endl;
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 2;
+    }
+
+    return 0;
+}
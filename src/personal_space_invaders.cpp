@@ -1,14 +1,291 @@
 #include "Game.hpp"
+#include "Startup.hpp"
 #include <iostream>
+#include <fstream>
+#include <chrono>
 
-int main()
+/*
+ * FUNCTION play_replay(std::string const &, float)
+ *
+ * Plays a replay file without window as fast as possible and
+ * prints how the game ended. With a time the replay first seeks
+ * there using the keyframes of the file, and prints how long that took.
+ */
+
+void play_replay(std::string const & file, float seconds)
+{
+    Replay replay{Replay::load(file)};
+    Game game{true};
+    Field field{game, replay.get_seed(), replay.get_difficulty()};
+    sf::Time delta{Field::tick};
+    size_t frame = std::min<size_t>(seconds / Field::tick.asSeconds(),
+				    replay.get_frames().size());
+
+    auto start = std::chrono::steady_clock::now();
+    replay.seek(field, frame);
+    std::chrono::duration<double> seek_time{std::chrono::steady_clock::now() - start};
+
+    for (; frame < replay.get_frames().size(); ++frame)
+	field.update(delta);
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    if (seconds > 0)
+	std::cout << "seek:    " << seek_time.count() * 1000 << " ms\n";
+
+    std::cout << "frames:  " << replay.get_frames().size() << "\n"
+	      << "pauses:  " << replay.get_pauses().size() << "\n"
+	      << "score:   " << field.get_score() << "\n"
+	      << "lives:   " << field.get_lives() << "\n"
+	      << "wave:    " << field.get_wave() << "\n"
+	      << "time:    " << field.get_time() << " s\n"
+	      << "speed:   " << field.get_time() / elapsed.count()
+	      << " x real time" << std::endl;
+}
+
+/*
+ * FUNCTION index_replay(std::string const &, float)
+ *
+ * Adds keyframes every seconds of game time to a replay file.
+ */
+
+void index_replay(std::string const & file, float seconds)
+{
+    Replay replay{Replay::load(file)};
+    Game game{true};
+    Field field{game, replay.get_seed(), replay.get_difficulty()};
+
+    replay.add_keyframes(field, std::max(1.0f, seconds / Field::tick.asSeconds()));
+    replay.save(file);
+}
+
+/*
+ * FUNCTION import_scores(std::string const &)
+ *
+ * Inserts every "alias:score" line of a text file in the top list,
+ * with its time if it has one, so that old scores do not show on
+ * the boards of the last week and day.
+ */
+
+void import_scores(std::string const & file)
 {
-    Game game;
+    if (!std::ifstream{file})
+	throw std::invalid_argument("Could not open " + file + "!");
+
+    Top_List toplist{Game::toplist_file, Game::toplist_text_file};
+
+    Score_Journal::read_scores(file, [&toplist](std::string const & alias, int score,
+						std::time_t made)
+			       {
+				   toplist.insert(alias, score, made);
+			       });
+}
+
+/*
+ * FUNCTION export_scores(std::string const &)
+ *
+ * Writes the top list to a text file, one "alias:score" line per
+ * alias, best first.
+ */
+
+void export_scores(std::string const & file)
+{
+    Top_List toplist{Game::toplist_file, Game::toplist_text_file};
+    std::ofstream out{file};
+
+    toplist.export_text(out);
+
+    if (!out.flush())
+	throw std::invalid_argument("Could not write " + file + "!");
+}
+
+/*
+ * FUNCTION merge_stats(std::string const &)
+ *
+ * Adds the games of a score sketch, such as the stats file of
+ * another machine, to the sketch of the top list file.
+ */
+
+void merge_stats(std::string const & file)
+{
+    if (!std::ifstream{file})
+	throw std::invalid_argument("Could not open " + file + "!");
+
+    Top_List toplist{Game::toplist_file, Game::toplist_text_file};
+
+    toplist.merge_stats(Score_Sketch::load(file));
+}
+
+/*
+ * FUNCTION usage(char const *)
+ *
+ * Prints the options and returns the exit code for bad options.
+ */
+
+int usage(char const * program)
+{
+    std::cout << "Usage: " << program
+	      << " [--record FILE | --replay FILE [SECONDS] | --index FILE [SECONDS]"
+	      << " | --import-scores FILE | --export-scores FILE | --merge-stats FILE]"
+	      << " [--stats-csv FILE] [--check-allocations report|abort]"
+	      << " [--hitch-budget MS] [--metrics PORT] [--startup wait|quit]"
+	      << " [--leaderboard HOST:PORT] [--shared-scores NAME]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char * argv[])
+{
+    std::string mode{};
+    std::string file{};
+    std::string stats_file{};
+    std::string check{};
+    float hitch_budget{20};
+    int metrics_port{-1};
+    std::string startup{};
+    std::string leaderboard{};
+    std::string shared_scores{};
+    bool game_options{false};
+    float seconds{-1};
+
+    for (int index{1}; index < argc; ++index)
+    {
+	std::string option{argv[index]};
+
+	if (index + 1 == argc)
+	    return usage(argv[0]);
+
+	if (option == "--stats-csv")
+	{
+	    stats_file = argv[++index];
+	    game_options = true;
+	}
+	else if (option == "--check-allocations")
+	{
+	    check = argv[++index];
+	    game_options = true;
+	}
+	else if (option == "--hitch-budget")
+	{
+	    hitch_budget = std::stof(argv[++index]);
+	    game_options = true;
+	}
+	else if (option == "--metrics")
+	{
+	    metrics_port = std::stoi(argv[++index]);
+	    game_options = true;
+	}
+	else if (option == "--startup")
+	{
+	    startup = argv[++index];
+	    game_options = true;
+	}
+	else if (option == "--leaderboard")
+	{
+	    leaderboard = argv[++index];
+	    game_options = true;
+	}
+	else if (option == "--shared-scores")
+	{
+	    shared_scores = argv[++index];
+	    game_options = true;
+	}
+	else if (mode.empty() && (option == "--record" || option == "--replay" ||
+				  option == "--index" || option == "--import-scores" ||
+				  option == "--export-scores" || option == "--merge-stats"))
+	{
+	    mode = option;
+	    file = argv[++index];
+
+	    if ((mode == "--replay" || mode == "--index") &&
+		index + 1 < argc && argv[index + 1][0] != '-')
+		seconds = std::stof(argv[++index]);
+	}
+	else
+	    return usage(argv[0]);
+    }
+
+    if (game_options && !mode.empty() && mode != "--record")
+	return usage(argv[0]);
+    if (!check.empty() && check != "report" && check != "abort")
+	return usage(argv[0]);
+    if (!startup.empty() && startup != "wait" && startup != "quit")
+	return usage(argv[0]);
+    if (!leaderboard.empty() && leaderboard.find(':') == std::string::npos)
+	return usage(argv[0]);
+
+    if (!startup.empty())
+    {
+	Startup::enable();
+	Startup::mark("options read");
+    }
 
     try
     {
+	if (mode == "--replay")
+	{
+	    play_replay(file, std::max(seconds, 0.0f));
+	    return 0;
+	}
+
+	if (mode == "--index")
+	{
+	    index_replay(file, seconds < 0 ? 30 : seconds);
+	    return 0;
+	}
+
+	if (mode == "--import-scores")
+	{
+	    import_scores(file);
+	    return 0;
+	}
+
+	if (mode == "--export-scores")
+	{
+	    export_scores(file);
+	    return 0;
+	}
+
+	if (mode == "--merge-stats")
+	{
+	    merge_stats(file);
+	    return 0;
+	}
+
+	Game game;
+
+	if (mode == "--record")
+	    game.record(file);
+
+	if (!stats_file.empty())
+	    game.write_stats(stats_file);
+
+	if (!check.empty())
+	    game.check_allocations(check == "abort" ? Allocations::ABORT
+				   : Allocations::REPORT);
+
+	game.set_hitch_budget(hitch_budget);
+
+	if (metrics_port >= 0)
+	    game.serve_metrics(metrics_port);
+
+	if (!leaderboard.empty())
+	{
+	    std::size_t colon{leaderboard.rfind(':')};
+	    game.use_leaderboard(leaderboard.substr(0, colon),
+				 std::stoi(leaderboard.substr(colon + 1)));
+	}
+
+	if (!shared_scores.empty())
+	    game.use_shared_scores(shared_scores);
+
+	if (!startup.empty())
+	    game.time_startup(startup == "quit");
+
 	game.run();
     }
+    catch (std::exception const & error)
+    {
+	std::cout << error.what() << std::endl;
+    }
     catch (...)
     {
 	std::cout << "Unknown error!" << std::endl;
@@ -0,0 +1,109 @@
+/*
+ * IDENTIFICATION
+ * File name:  psi_env.h
+ * Type:       C interface declaration
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * C interface to a batch of headless Field simulations, used to
+ * train bots. Built as the shared library libpsi_env.so.
+ *
+ * All buffers are owned by the caller and hold one element per
+ * game. Every step advances each game one frame (1/60 second).
+ *
+ * ACTIONS
+ * A bitmask per game of PSI_LEFT, PSI_RIGHT, PSI_SPACE and PSI_SHIFT,
+ * the keys held during the frame.
+ *
+ * OBSERVATIONS
+ * grid       the field divided in 32x32 pixel cells, each cell holds
+ *            the PSI_TYPE of the last entity covering it
+ * entities   position and size of up to PSI_MAX_ENTITIES entities
+ * score, lives, wave and time from the info strip
+ *
+ * REWARD
+ * The score gained during the step.
+ *
+ * ERRORS
+ * Functions returning int return 0 on success and -1 on failure,
+ * psi_env_error then describes the failure.
+ */
+
+#ifndef PSI_ENV_H
+#define PSI_ENV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PSI_GRID_WIDTH 32
+#define PSI_GRID_HEIGHT 24
+#define PSI_MAX_ENTITIES 128
+
+#define PSI_LEFT 1
+#define PSI_RIGHT 2
+#define PSI_SPACE 4
+#define PSI_SHIFT 8
+
+enum psi_type
+{
+    PSI_TYPE_EMPTY,
+    PSI_TYPE_PLAYER,
+    PSI_TYPE_ENEMY,
+    PSI_TYPE_BOSS,
+    PSI_TYPE_BLOCK,
+    PSI_TYPE_PLAYER_PROJECTILE,
+    PSI_TYPE_ENEMY_PROJECTILE
+};
+
+typedef struct psi_entity
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    int32_t type;
+} psi_entity;
+
+typedef struct psi_observation
+{
+    uint8_t grid[PSI_GRID_HEIGHT][PSI_GRID_WIDTH];
+    psi_entity entities[PSI_MAX_ENTITIES];
+    int32_t entity_count;
+    int32_t score;
+    int32_t lives;
+    int32_t wave;
+    float time;
+} psi_observation;
+
+typedef struct psi_env psi_env;
+
+/* Creates count games stepped on threads threads, 0 uses all cores. */
+psi_env * psi_env_create(int count, int threads);
+void psi_env_destroy(psi_env * env);
+char const * psi_env_error(psi_env const * env);
+
+/* Restarts every game with its seed and writes the first observations. */
+int psi_env_reset(psi_env * env, uint32_t const * seeds,
+		  psi_observation * observations);
+
+/* Restarts the game at index. */
+int psi_env_reset_one(psi_env * env, int index, uint32_t seed,
+		      psi_observation * observation);
+
+/* Steps every game that is not done. dones is set to 1 when the player
+ * has lost, the game then stays as it is until it is reset. */
+int psi_env_step(psi_env * env, uint8_t const * actions,
+		 psi_observation * observations, float * rewards,
+		 uint8_t * dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,426 @@
+/*
+ * IDENTIFICATION
+ * File name:  replay_bench.cpp
+ * Type:       Main program for the replay benchmark
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Plays the recorded sessions in replays/ through the whole
+ * Field::update, prints ticks per second, tick time percentiles
+ * and peak memory as JSON, and compares them with a baseline file.
+ * Every run of a session is played in a process of its own, so that
+ * its peak memory is not that of the sessions before it.
+ * Exits with 1 when a metric is worse than the baseline by more
+ * than the tolerance, so that it can gate performance changes.
+ *
+ * USAGE
+ * replay_bench [--baseline FILE] [--write-baseline FILE]
+ *              [--tolerance PERCENT] [--repeat N] [--render]
+ *              [--sessions DIR]
+ * replay_bench --record DIR
+ */
+
+#include "Game.hpp"
+#include "Game_State.hpp"
+#include "Replay.hpp"
+#include "Bot.hpp"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+
+#ifdef __unix__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Session
+{
+    string name{};
+    string bot{};
+    unsigned seed{};
+    Difficulty difficulty{};
+    float seconds{};
+};
+
+// The sessions, played by bots when recorded. "boss" sends a boss
+// every three seconds, "endless" has enemies that hardly ever shoot
+// so that the bot plays wave after wave.
+vector<Session> const sessions
+{
+    {"short",   "sweeper", 1, Difficulty{},                   60},
+    {"boss",    "sweeper", 2, Difficulty{12, 4, 100, 1.0, 3}, 180},
+    {"endless", "sweeper", 3, Difficulty{12, 4, 1000, 1.0, 30}, 1200}
+};
+
+// 1 for metrics where higher is better, -1 where lower is better and
+// 0 for those only reported, the longest tick is mostly noise
+map<string, int> const direction
+{
+    {"ticks_per_second", 1}, {"p50_us", -1}, {"p90_us", -1},
+    {"p99_us", -1}, {"max_us", 0}, {"peak_rss_kb", -1}
+};
+
+using Metrics = map<string, double>;
+
+/*
+ * FUNCTION record(string const &)
+ *
+ * Lets the bots play the sessions and saves them to the directory.
+ * A session ends early if the bot loses.
+ */
+
+void record(string const & directory)
+{
+    for (Session const & session : sessions)
+    {
+	Replay replay{session.seed, session.difficulty};
+	Game game{true};
+	Field field{game, session.seed, session.difficulty};
+	sf::Time delta{Field::tick};
+
+	field.set_input(make_unique<Recorder>(make_unique<Bot>(session.bot, session.seed),
+					      replay));
+	field.record_hashes(replay);
+
+	while (!field.is_over() && field.get_time() < session.seconds)
+	    field.update(delta);
+
+	replay.save(directory + "/" + session.name + ".psir");
+	cerr << session.name << ": " << replay.get_frames().size() << " frames, score "
+	     << field.get_score() << ", wave " << field.get_wave() << endl;
+    }
+}
+
+/*
+ * FUNCTION play(string const &, bool)
+ *
+ * Plays a session and measures every tick. When rendered every
+ * tick is also drawn to a hidden window, and the assets are loaded
+ * for real. The peak memory is measured by play_apart.
+ */
+
+Metrics play(string const & file, bool render)
+{
+    Replay replay{Replay::load(file)};
+    Game game{true};
+    Assets::set_headless(!render);
+
+    // The window is hidden, it is only a target to draw to
+    unique_ptr<sf::RenderWindow> window{};
+    if (render)
+    {
+	window = make_unique<sf::RenderWindow>(sf::VideoMode(1024, 768), "replay_bench");
+	window -> setVisible(false);
+	window -> setVerticalSyncEnabled(false);
+    }
+
+    Field field{game, replay.get_seed(), replay.get_difficulty()};
+    sf::Time delta{Field::tick};
+    vector<double> ticks{};
+
+    field.set_input(make_unique<Replay_Input>(replay.get_frames()));
+    ticks.reserve(replay.get_frames().size());
+
+    Clock::time_point start{Clock::now()};
+    for (size_t frame{}; frame < replay.get_frames().size(); ++frame)
+    {
+	Clock::time_point begin{Clock::now()};
+	field.update(delta);
+	if (window)
+	{
+	    window -> clear();
+	    field.draw(*window);
+	    window -> display();
+	}
+	ticks.push_back(chrono::duration<double, micro>(Clock::now() - begin).count());
+    }
+    double elapsed{chrono::duration<double>(Clock::now() - start).count()};
+
+    sort(begin(ticks), end(ticks));
+    auto percentile = [&ticks](double fraction)
+	{
+	    return ticks.empty() ? 0 : ticks.at(fraction * (ticks.size() - 1) + 0.5);
+	};
+
+    return Metrics{
+	{"ticks_per_second", elapsed > 0 ? ticks.size() / elapsed : 0},
+	{"p50_us", percentile(0.5)},
+	{"p90_us", percentile(0.9)},
+	{"p99_us", percentile(0.99)},
+	{"max_us", percentile(1.0)},
+	{"peak_rss_kb", 0}};
+}
+
+/*
+ * FUNCTION play_apart(string const &, bool)
+ *
+ * Plays a session in a child process and adds its peak resident
+ * memory in kilobytes, which wait4 gives for the child alone. The
+ * child sends the other metrics back as "metric value" lines, or an
+ * "error" line. Where there is no fork the session is played here
+ * and the peak memory is 0, not known.
+ */
+
+Metrics play_apart(string const & file, bool render)
+{
+#ifdef __unix__
+    int ends[2];
+    if (pipe(ends) != 0)
+	throw invalid_argument("Could not make a pipe!");
+
+    pid_t child{fork()};
+    if (child < 0)
+	throw invalid_argument("Could not start a process!");
+
+    if (child == 0)
+    {
+	close(ends[0]);
+	ostringstream out{};
+	out.precision(17);
+
+	try
+	{
+	    for (auto && metric : play(file, render))
+		out << metric.first << " " << metric.second << "\n";
+	}
+	catch (exception const & error)
+	{
+	    out.str("");
+	    out << "error " << error.what();
+	}
+
+	string text{out.str()};
+	for (size_t written{}; written < text.size(); )
+	{
+	    ssize_t count{write(ends[1], text.data() + written, text.size() - written)};
+	    if (count <= 0)
+		_exit(1);
+	    written += count;
+	}
+	_exit(0);
+    }
+
+    close(ends[1]);
+    string text{};
+    char buffer[4096];
+    for (ssize_t count{}; (count = read(ends[0], buffer, sizeof(buffer))) > 0; )
+	text.append(buffer, count);
+    close(ends[0]);
+
+    int status{};
+    rusage usage{};
+    if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) ||
+	WEXITSTATUS(status) != 0)
+	throw invalid_argument("The run of " + file + " failed!");
+
+    if (text.compare(0, 6, "error ") == 0)
+	throw invalid_argument(text.substr(6));
+
+    Metrics metrics{};
+    istringstream in{text};
+    string metric{};
+    double value{};
+    while (in >> metric >> value)
+	metrics[metric] = value;
+
+    metrics["peak_rss_kb"] = usage.ru_maxrss;
+    return metrics;
+#else
+    return play(file, render);
+#endif
+}
+
+/*
+ * FUNCTION best(Metrics const &, Metrics const &)
+ *
+ * Returns the best value of every metric of two runs, the runs that
+ * were disturbed by something else on the machine are left out.
+ */
+
+Metrics best(Metrics const & one, Metrics const & other)
+{
+    Metrics result{one};
+
+    for (auto && metric : other)
+	if (direction.at(metric.first) > 0)
+	    result[metric.first] = max(result[metric.first], metric.second);
+	else
+	    result[metric.first] = min(result[metric.first], metric.second);
+
+    return result;
+}
+
+/*
+ * FUNCTION read_baseline(string const &)
+ *
+ * Reads a baseline file, one "session metric value" per line.
+ */
+
+map<string, Metrics> read_baseline(string const & file)
+{
+    ifstream in{file};
+    if (!in)
+	throw invalid_argument("Baseline " + file + " not found!");
+
+    map<string, Metrics> baseline{};
+    string session{}, metric{};
+    double value{};
+
+    while (in >> session >> metric >> value)
+	baseline[session][metric] = value;
+
+    return baseline;
+}
+
+/*
+ * FUNCTION write_baseline(string const &, map<string, Metrics> const &)
+ *
+ * Writes the results to a baseline file. The sessions of the file
+ * that were not run, the rendered ones or the headless ones, are kept.
+ */
+
+void write_baseline(string const & file, map<string, Metrics> const & results)
+{
+    map<string, Metrics> baseline{};
+    if (ifstream{file})
+	baseline = read_baseline(file);
+
+    for (auto && session : results)
+	baseline[session.first] = session.second;
+
+    ofstream out{file};
+
+    for (auto && session : baseline)
+	for (auto && metric : session.second)
+	    out << session.first << " " << metric.first << " " << metric.second << "\n";
+}
+
+int main(int argc, char * argv[])
+{
+    string baseline_file{};
+    string new_baseline_file{};
+    string directory{"replays"};
+    string record_directory{};
+    double tolerance{15};
+    int repeat{3};
+    bool render{false};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (option == "--render")
+	    {
+		render = true;
+		continue;
+	    }
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    string value{argv[++index]};
+
+	    if (option == "--baseline")
+		baseline_file = value;
+	    else if (option == "--write-baseline")
+		new_baseline_file = value;
+	    else if (option == "--tolerance")
+		tolerance = stod(value);
+	    else if (option == "--repeat")
+		repeat = max(stoi(value), 1);
+	    else if (option == "--sessions")
+		directory = value;
+	    else if (option == "--record")
+		record_directory = value;
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+
+	if (!record_directory.empty())
+	{
+	    record(record_directory);
+	    return 0;
+	}
+
+	map<string, Metrics> baseline{};
+	if (!baseline_file.empty())
+	    baseline = read_baseline(baseline_file);
+
+	// Rendered runs are compared with rendered runs in the baseline
+	map<string, Metrics> results{};
+	for (Session const & session : sessions)
+	{
+	    string name{session.name + (render ? "_render" : "")};
+	    string file{directory + "/" + session.name + ".psir"};
+
+	    cerr << name << endl;
+	    results[name] = play_apart(file, render);
+	    for (int run{1}; run < repeat; ++run)
+		results[name] = best(results[name], play_apart(file, render));
+	}
+
+	if (!new_baseline_file.empty())
+	    write_baseline(new_baseline_file, results);
+
+	vector<string> regressions{};
+
+	cout << "{\n"
+	     << "  \"render\": " << (render ? "true" : "false") << ",\n"
+	     << "  \"tolerance_percent\": " << tolerance << ",\n"
+	     << "  \"sessions\": [\n";
+
+	for (auto && session : results)
+	{
+	    string const & name{session.first};
+	    cout << "    {\"name\": \"" << name << "\"";
+
+	    for (auto && metric : session.second)
+	    {
+		cout << ", \"" << metric.first << "\": " << metric.second;
+
+		auto expected = baseline[name].find(metric.first);
+		if (expected == baseline[name].end() || expected -> second <= 0 ||
+		    direction.at(metric.first) == 0)
+		    continue;
+
+		// The change in percent, positive when it got worse
+		double change = (expected -> second - metric.second) / expected -> second * 100 *
+		    direction.at(metric.first);
+
+		cout << ", \"" << metric.first << "_change_percent\": " << change;
+		if (change > tolerance)
+		    regressions.push_back(name + " " + metric.first + ": " +
+					  to_string(metric.second) + " against " +
+					  to_string(expected -> second));
+	    }
+
+	    cout << "}" << (name == results.rbegin() -> first ? "" : ",") << "\n";
+	}
+
+	cout << "  ],\n"
+	     << "  \"regressions\": " << regressions.size() << "\n}" << endl;
+
+	for (string const & regression : regressions)
+	    cerr << "Regression in " << regression << endl;
+
+	return regressions.empty() ? 0 : 1;
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 2;
+    }
+}
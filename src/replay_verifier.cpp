@@ -0,0 +1,284 @@
+/*
+ * IDENTIFICATION
+ * File name:  replay_verifier.cpp
+ * Type:       Main program for the replay verifier
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Checks submitted scores by playing their replays again, headless
+ * and on all cores. A score is accepted only if the replayed game
+ * ends with the same score in the Info_Strip. A replay with state
+ * hashes is also compared with the game as it was recorded once a
+ * second, and the first second where they differ is reported.
+ *
+ * The submissions are "alias<TAB>score<TAB>replay" lines, as in the
+ * FILE.queue a game recorded with --record FILE writes, or given one
+ * at a time with --submit. A line per submission is printed, and the
+ * accepted scores can be written as "alias:score" lines for
+ * personal_space_invaders --import-scores.
+ *
+ * USAGE
+ * replay_verifier [--threads N] [--accepted FILE] [--queue FILE]...
+ *                 [--submit ALIAS SCORE REPLAY]...
+ */
+
+#include "Game.hpp"
+#include "Game_State.hpp"
+#include "Replay.hpp"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+struct Submission
+{
+    string alias{};
+    int score{};
+    string file{};
+};
+
+struct Verdict
+{
+    bool accepted{};
+    string reason{};
+};
+
+/*
+ * FUNCTION read_queue(string const &, vector<Submission> &)
+ *
+ * Adds the "alias<TAB>score<TAB>replay" lines of a queue file.
+ */
+
+void read_queue(string const & file, vector<Submission> & submissions)
+{
+    ifstream in{file};
+    if (!in)
+	throw invalid_argument("Queue " + file + " not found!");
+
+    string line{};
+    for (size_t number{1}; getline(in, line); ++number)
+    {
+	if (line.empty())
+	    continue;
+
+	size_t first{line.find('\t')};
+	size_t second{first == string::npos ? first : line.find('\t', first + 1)};
+
+	try
+	{
+	    if (second == string::npos)
+		throw invalid_argument("no replay");
+
+	    submissions.push_back(Submission{line.substr(0, first),
+			stoi(line.substr(first + 1, second - first - 1)),
+			line.substr(second + 1)});
+	}
+	catch (exception const &)
+	{
+	    throw invalid_argument(file + ":" + to_string(number) + " is not a submission!");
+	}
+    }
+}
+
+/*
+ * FUNCTION standard(Difficulty const &)
+ *
+ * True if a difficulty is the one every game is played with.
+ */
+
+bool standard(Difficulty const & difficulty)
+{
+    Difficulty const normal{};
+
+    return difficulty.enemy_columns == normal.enemy_columns &&
+	difficulty.enemy_rows == normal.enemy_rows &&
+	difficulty.enemy_shot_chance == normal.enemy_shot_chance &&
+	difficulty.enemy_shot_delay == normal.enemy_shot_delay &&
+	difficulty.boss_interval == normal.boss_interval;
+}
+
+/*
+ * FUNCTION verify(Submission const &)
+ *
+ * Plays the replay of a submission on a new Field. Only replays like
+ * those the game records are played, of the latest version and with
+ * the standard difficulty, since a made up file with a huge field
+ * could make the verifier run out of memory or time. The state hash
+ * at the end of every hash interval is compared with the recorded
+ * one, and the first interval that differs rejects the score. Only
+ * the hashes at the ends of the intervals are recorded, so the game
+ * went another way somewhere in that interval. Otherwise the game
+ * must be over at the end of the replay, with the score submitted.
+ */
+
+Verdict verify(Submission const & submission)
+{
+    Replay replay{};
+
+    try
+    {
+	replay = Replay::load(submission.file);
+    }
+    catch (invalid_argument const & error)
+    {
+	return Verdict{false, error.what()};
+    }
+
+    if (replay.get_version() != Replay::latest_version)
+	return Verdict{false, "the replay is of version " + to_string(replay.get_version())};
+
+    if (!standard(replay.get_difficulty()))
+	return Verdict{false, "the replay is not of the standard difficulty"};
+
+    Game game{true};
+    Field field{game, replay.get_seed(), replay.get_difficulty()};
+    sf::Time delta{Field::tick};
+    vector<uint8_t> const & frames{replay.get_frames()};
+    vector<uint32_t> const & hashes{replay.get_hashes()};
+    size_t interval{replay.get_hash_interval()};
+
+    field.set_input(make_unique<Replay_Input>(frames));
+
+    for (size_t frame{}; frame < frames.size(); ++frame)
+    {
+	field.update(delta);
+
+	size_t hash{(frame + 1) / interval};
+	if ((frame + 1) % interval != 0 || hash > hashes.size())
+	    continue;
+
+	if (field.state_hash() != hashes[hash - 1])
+	{
+	    size_t first{frame + 1 - interval};
+	    return Verdict{false, "differs from the recording between frame " +
+		    to_string(first) + " and " + to_string(frame) + ", " +
+		    to_string(first * Field::tick.asSeconds()) + " to " +
+		    to_string(frame * Field::tick.asSeconds()) + " s"};
+	}
+    }
+
+    if (!field.is_over())
+	return Verdict{false, "the game is not over at the end of the replay"};
+
+    if (field.get_score() != submission.score)
+	return Verdict{false, "the replay scores " + to_string(field.get_score())};
+
+    return Verdict{true, {}};
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned threads{max(thread::hardware_concurrency(), 1u)};
+    string accepted_file{};
+    vector<Submission> submissions{};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (option == "--submit")
+	    {
+		if (index + 3 >= argc)
+		    throw invalid_argument("--submit needs an alias, a score and a replay!");
+
+		submissions.push_back(Submission{argv[index + 1], stoi(argv[index + 2]),
+			    argv[index + 3]});
+		index += 3;
+		continue;
+	    }
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    string value{argv[++index]};
+
+	    if (option == "--threads")
+		threads = max(stoi(value), 1);
+	    else if (option == "--accepted")
+		accepted_file = value;
+	    else if (option == "--queue")
+		read_queue(value, submissions);
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 1;
+    }
+
+    // The workers take the next submission when done, long games
+    // do not hold up the others
+    vector<Verdict> verdicts(submissions.size());
+    atomic<size_t> next_submission{0};
+
+    auto worker = [&]()
+	{
+	    for (size_t index{next_submission++}; index < submissions.size();
+		 index = next_submission++)
+	    {
+		try
+		{
+		    verdicts.at(index) = verify(submissions.at(index));
+		}
+		catch (exception const & error)
+		{
+		    verdicts.at(index) = Verdict{false, error.what()};
+		}
+	    }
+	};
+
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers{};
+    for (unsigned count{}; count < min<size_t>(threads, submissions.size()); ++count)
+	workers.emplace_back(worker);
+    for (thread & thread : workers)
+	thread.join();
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream accepted_out{};
+    if (!accepted_file.empty())
+	accepted_out.open(accepted_file);
+
+    size_t accepted{};
+    for (size_t index{}; index < submissions.size(); ++index)
+    {
+	Submission const & submission{submissions[index]};
+	Verdict const & verdict{verdicts[index]};
+
+	cout << (verdict.accepted ? "accepted" : "rejected") << "\t" << submission.alias
+	     << "\t" << submission.score << "\t" << submission.file;
+	if (!verdict.accepted)
+	    cout << "\t" << verdict.reason;
+	cout << "\n";
+
+	if (verdict.accepted)
+	{
+	    ++accepted;
+	    if (accepted_out.is_open())
+		accepted_out << submission.alias << ':' << submission.score << '\n';
+	}
+    }
+
+    cerr << submissions.size() << " submissions, " << accepted << " accepted, "
+	 << submissions.size() - accepted << " rejected in " << elapsed << " s" << endl;
+
+    if (accepted_out.is_open() && !accepted_out.flush())
+    {
+	cerr << "Could not write " << accepted_file << "!" << endl;
+	return 1;
+    }
+
+    return accepted == submissions.size() ? 0 : 2;
+}
@@ -0,0 +1,338 @@
+/*
+ * IDENTIFICATION
+ * File name:  shared_stress.cpp
+ * Type:       Main program for the shared scores stress test
+ * Written by: A. Westlund
+ *             F. Flodin
+ *             A. Nikonoff
+ *             K. Palm
+ *
+ * DESCRIPTION
+ * Forks many writer processes that insert scores into top lists that
+ * share one segment and one file, and reader processes that check
+ * every best list and log entry they read for torn or unsorted rows
+ * while the writers run. When all are done the best scores of the
+ * segment, its log and the file are compared with what was written.
+ * Exits with 0 if everything was as expected.
+ *
+ * USAGE
+ * shared_stress [--writers N] [--readers N] [--scores N]
+ */
+
+#include "Shared_Scores.hpp"
+#include "Top_List.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// A score every common_interval is also given to a common alias
+#define common_interval 10
+#define common_aliases 8
+
+using namespace std;
+
+/*
+ * FUNCTION score_of(unsigned, unsigned)
+ *
+ * The score writer gives its score number.
+ */
+
+static int score_of(unsigned writer, unsigned number)
+{
+    return int((number * 7919ull + writer * 104729ull) % 1000003);
+}
+
+/*
+ * FUNCTION valid_row(string const &, int)
+ *
+ * True if a row is one a writer could have written, so that a row
+ * with the alias of one score and the score of another is found.
+ */
+
+static bool valid_row(string const & alias, int score)
+{
+    unsigned writer{};
+    unsigned number{};
+
+    if (sscanf(alias.c_str(), "w%u_%u", &writer, &number) == 2)
+	return alias == "w" + to_string(writer) + "_" + to_string(number) &&
+	    score == score_of(writer, number);
+
+    return alias.compare(0, 6, "common") == 0 && score >= 0 && score < 1000003;
+}
+
+/*
+ * FUNCTION better(pair<string, int> const &, pair<string, int> const &)
+ *
+ * The order of the best scores, higher first and equal by alias.
+ */
+
+static bool better(pair<string, int> const & row, pair<string, int> const & other)
+{
+    if (row.second == other.second)
+	return row.first < other.first;
+    return row.second > other.second;
+}
+
+/*
+ * FUNCTION write_scores(string const &, string const &, unsigned, unsigned)
+ *
+ * A writer process. Inserts its scores into a top list shared with
+ * the others, and saved to the same file.
+ */
+
+static int write_scores(string const & name, string const & file, unsigned writer,
+			unsigned scores)
+{
+    Top_List toplist{file};
+    toplist.share(name);
+
+    for (unsigned number{}; number < scores; ++number)
+    {
+	int score{score_of(writer, number)};
+	toplist.insert("w" + to_string(writer) + "_" + to_string(number), score);
+	toplist.record_game(score);
+
+	if (number % common_interval == 0)
+	{
+	    toplist.insert("common" + to_string(number / common_interval % common_aliases), score);
+	    toplist.record_game(score);
+	}
+    }
+
+    return 0;
+}
+
+/*
+ * FUNCTION read_scores(string const &, uint64_t)
+ *
+ * A reader process. Reads the best scores and the log until all
+ * scores were published, and returns 1 if any row read was torn,
+ * unsorted or there twice.
+ */
+
+static int read_scores(string const & name, uint64_t published)
+{
+    Shared_Scores shared{name};
+    Shared_Scores::Rows rows{};
+    uint32_t sequence{1};
+    uint64_t next{};
+    uint64_t tables{};
+    uint64_t entries{};
+    bool failed{false};
+
+    auto check = [&failed, &entries](string const & alias, int score)
+	{
+	    ++entries;
+	    if (!valid_row(alias, score))
+	    {
+		cerr << "Torn log entry " << alias << ":" << score << endl;
+		failed = true;
+	    }
+	};
+
+    do
+    {
+	shared.read_log(next, check);
+
+	if (!shared.read_top(rows, sequence))
+	    continue;
+
+	++tables;
+	for (size_t index{}; index < rows.size(); ++index)
+	{
+	    if (!valid_row(rows[index].first, rows[index].second))
+	    {
+		cerr << "Torn row " << rows[index].first << ":" << rows[index].second << endl;
+		failed = true;
+	    }
+
+	    if (index > 0 && !better(rows[index - 1], rows[index]))
+	    {
+		cerr << "Rows out of order at " << index << endl;
+		failed = true;
+	    }
+	}
+    }
+    while (shared.log_end() < published);
+
+    cerr << "reader " << getpid() << ": " << tables << " lists, "
+	 << entries << " log entries" << endl;
+    return failed ? 1 : 0;
+}
+
+/*
+ * FUNCTION start(function<int()> const &)
+ *
+ * Forks a process that runs the function and exits with its result.
+ */
+
+static pid_t start(function<int()> const & process)
+{
+    pid_t child{fork()};
+
+    if (child == 0)
+    {
+	int status{1};
+	try
+	{
+	    status = process();
+	}
+	catch (exception const & error)
+	{
+	    cerr << error.what() << endl;
+	}
+	_exit(status);
+    }
+
+    if (child < 0)
+	throw runtime_error("Could not fork!");
+
+    return child;
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned writers{8};
+    unsigned readers{4};
+    unsigned scores{20000};
+
+    try
+    {
+	for (int index{1}; index < argc; ++index)
+	{
+	    string option{argv[index]};
+
+	    if (index + 1 >= argc)
+		throw invalid_argument("Missing value for " + option + "!");
+
+	    int value{max(stoi(argv[++index]), 0)};
+
+	    if (option == "--writers")
+		writers = max(value, 1);
+	    else if (option == "--readers")
+		readers = value;
+	    else if (option == "--scores")
+		scores = max(value, 1);
+	    else
+		throw invalid_argument("Unknown option " + option + "!");
+	}
+
+	char folder[]{"/tmp/shared_stress.XXXXXX"};
+	if (!mkdtemp(folder))
+	    throw runtime_error("Could not make a folder!");
+
+	string name{"psi_stress_" + to_string(getpid())};
+	string file{string{folder} + "/toplist.bin"};
+	uint64_t published{uint64_t(writers) *
+			   (scores + (scores + common_interval - 1) / common_interval)};
+
+	// Set up before any process starts, so that none seeds it
+	Shared_Scores::remove(name);
+	Shared_Scores shared{name};
+
+	auto start_time = chrono::steady_clock::now();
+	vector<pid_t> children{};
+
+	for (unsigned reader{}; reader < readers; ++reader)
+	    children.push_back(start([&name, published]() { return read_scores(name, published); }));
+
+	for (unsigned writer{}; writer < writers; ++writer)
+	    children.push_back(start([&name, &file, writer, scores]()
+				     {
+					 return write_scores(name, file, writer, scores);
+				     }));
+
+	bool failed{false};
+	for (pid_t child : children)
+	{
+	    int status{};
+	    waitpid(child, &status, 0);
+	    failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	}
+
+	chrono::duration<double> elapsed{chrono::steady_clock::now() - start_time};
+
+	// The best score of every alias
+	map<string, int> best{};
+	for (unsigned writer{}; writer < writers; ++writer)
+	    for (unsigned number{}; number < scores; ++number)
+	    {
+		int score{score_of(writer, number)};
+		best["w" + to_string(writer) + "_" + to_string(number)] = score;
+
+		string common{"common" + to_string(number / common_interval % common_aliases)};
+		if (number % common_interval == 0 && (!best.count(common) || best[common] < score))
+		    best[common] = score;
+	    }
+
+	Shared_Scores::Rows expected(begin(best), end(best));
+	sort(begin(expected), end(expected), better);
+	expected.resize(min<size_t>(expected.size(), Shared_Scores::top_capacity));
+
+	Shared_Scores::Rows rows{};
+	uint32_t sequence{1};
+	shared.read_top(rows, sequence);
+
+	if (rows != expected)
+	{
+	    cerr << "The best scores differ from those written" << endl;
+	    failed = true;
+	}
+
+	if (shared.log_end() != published)
+	{
+	    cerr << "The log has " << shared.log_end() << " scores, not " << published << endl;
+	    failed = true;
+	}
+
+	Top_List saved{file};
+	size_t missing{};
+	for (auto && row : saved.get(saved.size()))
+	    if (best.at(row.first) != row.second)
+		++missing;
+
+	if (saved.size() != best.size() || missing > 0)
+	{
+	    cerr << "The file has " << saved.size() << " aliases, not " << best.size()
+		 << ", and " << missing << " wrong scores" << endl;
+	    failed = true;
+	}
+
+	// Every writer merged the games of its session into the stats
+	if (saved.get_stats().count() != published)
+	{
+	    cerr << "The stats have " << saved.get_stats().count() << " games, not "
+		 << published << endl;
+	    failed = true;
+	}
+
+	Shared_Scores::remove(name);
+	for (string suffix : {"", ".journal", ".journal.old", ".lock", ".recent", ".stats",
+			      ".stats.lock"})
+	    remove((file + suffix).c_str());
+	rmdir(folder);
+
+	cout << "writers:   " << writers << "\n"
+	     << "readers:   " << readers << "\n"
+	     << "scores:    " << published << "\n"
+	     << "time:      " << elapsed.count() << " s\n"
+	     << "rate:      " << published / elapsed.count() << " scores/s\n"
+	     << "result:    " << (failed ? "FAILED" : "ok") << endl;
+
+	return failed ? 1 : 0;
+    }
+    catch (exception const & error)
+    {
+	cerr << error.what() << endl;
+	return 2;
+    }
+}